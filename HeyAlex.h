@@ -1,15 +0,0 @@
-#ifndef HEY_ALEX_H
-#define HEY_ALEX_H
-
-#include <stdint.h>
-
-// Bu dizi Picovoice Console'dan indirdiğiniz .h dosyasının içindeki
-// 'pv_porcupine_model' dizisi ile değiştirilmelidir.
-// Varsayılan olarak boş veya placeholder veri içerir.
-
-const uint8_t KEYWORD_MODEL[] = {
-    // BURAYA PICOVOICE MODEL VERİSİNİ YAPIŞTIRIN
-    // Örnek: 0x44, 0x41, 0x54, ...
-};
-
-#endif // HEY_ALEX_H
@@ -22,6 +22,8 @@
 #include <ArduinoJson.h>
 #include <driver/i2s.h>
 
+#include "audio_pipeline.h" // Pinler, SAMPLE_RATE, I2S kurulumu
+
 // ============================================
 //  KULLANICI AYARLARI — BUNLARI DEĞİŞTİR!
 // ============================================
@@ -29,24 +31,9 @@
 #define WIFI_PASSWORD   "Şifren"
 #define GOOGLE_API_KEY  "YOUR_GOOGLE_API_KEY"
 
-// ============================================
-//  PIN TANIMLAMALARI
-// ============================================
-#define MIC_WS_PIN    5
-#define MIC_SCK_PIN   6
-#define MIC_SD_PIN    4
-#define MIC_PORT      I2S_NUM_0
-
-#define SPK_BCLK_PIN  9
-#define SPK_LRC_PIN   10
-#define SPK_DIN_PIN   8
-#define SPK_PORT      I2S_NUM_1
-
 // ============================================
 //  SABİTLER
 // ============================================
-#define SAMPLE_RATE           16000
-#define BUFFER_LENGTH         512
 #define MAX_RECORD_SAMPLES    (SAMPLE_RATE * 5)
 #define WAKE_THRESHOLD        1500
 #define WAKE_CONFIRM_MS       300
@@ -153,7 +140,7 @@ void loop() {
   i2s_read(MIC_PORT, &rawBuffer, sizeof(rawBuffer), &bytesRead, portMAX_DELAY);
   if (bytesRead == 0) return;
 
-  float rms = calculateRMS(bytesRead / sizeof(int32_t));
+  float rms = MicAudio::rms(rawBuffer, bytesRead / sizeof(int32_t));
 
   switch (currentState) {
 
@@ -176,9 +163,9 @@ void loop() {
       if (rms > WAKE_THRESHOLD / 2) lastSoundTime = millis();
 
       int samplesRead = bytesRead / sizeof(int32_t);
-      for (int i = 0; i < samplesRead && recordIndex < MAX_RECORD_SAMPLES; i++) {
-        recordBuffer[recordIndex++] = (int16_t)(rawBuffer[i] >> 16);
-      }
+      int n = min(samplesRead, MAX_RECORD_SAMPLES - recordIndex);
+      MicAudio::toPcm16(rawBuffer, recordBuffer + recordIndex, n);
+      recordIndex += n;
 
       bool silenceEnd = (millis() - lastSoundTime > SILENCE_TIMEOUT_MS);
       bool bufferFull = (recordIndex >= MAX_RECORD_SAMPLES);
@@ -460,15 +447,6 @@ void wifi_connect() {
 // ============================================
 //  YARDIMCI FONKSİYONLAR
 // ============================================
-float calculateRMS(int samplesRead) {
-  long long sum = 0;
-  for (int i = 0; i < samplesRead; i++) {
-    int32_t s = rawBuffer[i] >> 14;
-    sum += (long long)s * s;
-  }
-  return sqrt((float)sum / samplesRead);
-}
-
 void setState(SystemState s) {
   currentState = s;
   const char* names[] = {"IDLE", "LISTENING", "THINKING", "SPEAKING"};
@@ -480,53 +458,11 @@ void setState(SystemState s) {
 }
 
 void i2s_mic_init() {
-  i2s_config_t cfg = {
-    .mode                 = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-    .sample_rate          = SAMPLE_RATE,
-    .bits_per_sample      = I2S_BITS_PER_SAMPLE_32BIT,
-    .channel_format       = I2S_CHANNEL_FMT_ONLY_LEFT,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-    .intr_alloc_flags     = ESP_INTR_FLAG_LEVEL1,
-    .dma_buf_count        = 8,
-    .dma_buf_len          = BUFFER_LENGTH,
-    .use_apll             = false,
-    .tx_desc_auto_clear   = false,
-    .fixed_mclk           = 0
-  };
-  i2s_pin_config_t pins = {
-    .bck_io_num   = MIC_SCK_PIN,
-    .ws_io_num    = MIC_WS_PIN,
-    .data_out_num = I2S_PIN_NO_CHANGE,
-    .data_in_num  = MIC_SD_PIN
-  };
-  i2s_driver_install(MIC_PORT, &cfg, 0, NULL);
-  i2s_set_pin(MIC_PORT, &pins);
-  i2s_zero_dma_buffer(MIC_PORT);
+  MicAudio::install(MIC_PORT);
   Serial.println("[I2S] Mikrofon hazır.");
 }
 
 void i2s_speaker_init() {
-  i2s_config_t cfg = {
-    .mode                 = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
-    .sample_rate          = SAMPLE_RATE,
-    .bits_per_sample      = I2S_BITS_PER_SAMPLE_16BIT,
-    .channel_format       = I2S_CHANNEL_FMT_ONLY_LEFT,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-    .intr_alloc_flags     = ESP_INTR_FLAG_LEVEL1,
-    .dma_buf_count        = 8,
-    .dma_buf_len          = BUFFER_LENGTH,
-    .use_apll             = false,
-    .tx_desc_auto_clear   = true,
-    .fixed_mclk           = 0
-  };
-  i2s_pin_config_t pins = {
-    .bck_io_num   = SPK_BCLK_PIN,
-    .ws_io_num    = SPK_LRC_PIN,
-    .data_out_num = SPK_DIN_PIN,
-    .data_in_num  = I2S_PIN_NO_CHANGE
-  };
-  i2s_driver_install(SPK_PORT, &cfg, 0, NULL);
-  i2s_set_pin(SPK_PORT, &pins);
-  i2s_zero_dma_buffer(SPK_PORT);
+  SpeakerAudio::install(SPK_PORT);
   Serial.println("[I2S] Hoparlör hazır.");
 }
\ No newline at end of file
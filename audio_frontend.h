@@ -0,0 +1,180 @@
+#ifndef AUDIO_FRONTEND_H
+#define AUDIO_FRONTEND_H
+
+// ============================================
+//  SES ÖN İŞLEME (Fixed-point, blok tabanlı)
+// ============================================
+//  INMP441 (32-bit kelimenin üst 24 biti) -> 16-bit PCM (STT için)
+//   1. DC engelleyici   : y = x - x1 + R*y1          (R = 0.995, Q15)
+//   2. Yüksek geçiren   : 2. derece Butterworth, 80 Hz (Q28 biquad)
+//   3. AGC + limiter    : Blok RMS'ine göre kazanç, blok tepesine göre
+//                         anlık kazanç düşürme (blok kadar ileri bakış)
+//  24-bit çözünürlük kazanç uygulanana kadar korunur; 16-bit'e sadece en
+//  sonda inilir. Blok başına tek sqrt, örnek başına sadece tamsayı çarpma.
+
+#include <math.h>
+#include <stdint.h>
+
+#define AFE_MAX_BLOCK 512
+
+// HPF katsayıları (fs = 16 kHz, fc = 80 Hz, Q = 0.707), Q28
+#define AFE_HPF_B0 262538058
+#define AFE_HPF_B1 -525076115
+#define AFE_HPF_B2 262538058
+#define AFE_HPF_A1 -524946537
+#define AFE_HPF_A2 256770238
+#define AFE_DC_R_Q15 32604
+
+// AGC ayarları (16-bit ölçeğinde)
+#define AFE_TARGET_RMS 3000        // ~ -21 dBFS konuşma seviyesi
+#define AFE_NOISE_GATE_RMS 120     // Altındaysa kazanç dondurulur (sessizlik)
+#define AFE_LIMIT 29000            // Limiter tavanı (~ -1 dBFS)
+#define AFE_GAIN_UNITY (1 << 16)   // Q16, 24-bit -> 16-bit dönüşümü dahil değil
+#define AFE_MAX_GAIN (32 << 16)    // +30 dB
+#define AFE_MIN_GAIN (1 << 15)     // -6 dB
+#define AFE_ATTACK_SHIFT 1         // Kazanç düşerken hızlı (1/2)
+#define AFE_RELEASE_SHIFT 4        // Kazanç artarken yavaş (1/16)
+
+struct AudioFrontEnd {
+  // DC engelleyici durumu
+  int32_t dcX1;
+  int32_t dcY1;
+  // Biquad (Direct Form I) durumu
+  int32_t x1, x2, y1, y2;
+  // AGC
+  int32_t gain; // Q16
+  uint16_t lastRms;
+  uint16_t lastPeak;
+  uint32_t limited; // Limiter'ın devreye girdiği blok sayısı
+  // Ölçüm
+  uint64_t cycles;
+  uint32_t blocks;
+  int32_t work[AFE_MAX_BLOCK];
+};
+
+inline void afeInit(AudioFrontEnd &fe) {
+  fe.dcX1 = fe.dcY1 = 0;
+  fe.x1 = fe.x2 = fe.y1 = fe.y2 = 0;
+  fe.gain = AFE_GAIN_UNITY;
+  fe.lastRms = fe.lastPeak = 0;
+  fe.limited = 0;
+  fe.cycles = 0;
+  fe.blocks = 0;
+}
+
+inline int16_t afeSaturate16(int64_t v) {
+  if (v > 32767)
+    return 32767;
+  if (v < -32768)
+    return -32768;
+  return (int16_t)v;
+}
+
+// in: I2S'den gelen ham 32-bit örnekler, out: 16-bit PCM. n <= AFE_MAX_BLOCK
+inline void afeProcess(AudioFrontEnd &fe, const int32_t *in, int16_t *out,
+                       int n) {
+  if (n <= 0)
+    return;
+  if (n > AFE_MAX_BLOCK)
+    n = AFE_MAX_BLOCK;
+
+  // --- Geçiş 1: DC + HPF (24-bit), blok enerji ve tepe ---
+  int32_t dcX1 = fe.dcX1, dcY1 = fe.dcY1;
+  int32_t x1 = fe.x1, x2 = fe.x2, y1 = fe.y1, y2 = fe.y2;
+  int64_t energy = 0;
+  int32_t peak = 0;
+  for (int i = 0; i < n; i++) {
+    int32_t x = in[i] >> 8; // 24-bit işaretli
+
+    int32_t d = x - dcX1 + (int32_t)(((int64_t)AFE_DC_R_Q15 * dcY1) >> 15);
+    dcX1 = x;
+    dcY1 = d;
+
+    int64_t acc = (int64_t)AFE_HPF_B0 * d + (int64_t)AFE_HPF_B1 * x1 +
+                  (int64_t)AFE_HPF_B2 * x2 - (int64_t)AFE_HPF_A1 * y1 -
+                  (int64_t)AFE_HPF_A2 * y2;
+    int32_t y = (int32_t)(acc >> 28);
+    x2 = x1;
+    x1 = d;
+    y2 = y1;
+    y1 = y;
+
+    fe.work[i] = y;
+    int32_t s16 = y >> 8;
+    energy += (int64_t)s16 * s16;
+    int32_t a = y < 0 ? -y : y;
+    if (a > peak)
+      peak = a;
+  }
+  fe.dcX1 = dcX1;
+  fe.dcY1 = dcY1;
+  fe.x1 = x1;
+  fe.x2 = x2;
+  fe.y1 = y1;
+  fe.y2 = y2;
+
+  // --- AGC: blok başına bir kez ---
+  int32_t rms = (int32_t)sqrtf((float)energy / n); // 16-bit ölçeği
+  int32_t peak16 = peak >> 8;
+  fe.lastRms = (uint16_t)(rms > 65535 ? 65535 : rms);
+  fe.lastPeak = (uint16_t)(peak16 > 65535 ? 65535 : peak16);
+
+  int32_t gainStart = fe.gain;
+  int32_t gainEnd = gainStart;
+  if (rms > AFE_NOISE_GATE_RMS) {
+    int64_t want = ((int64_t)AFE_TARGET_RMS << 16) / rms;
+    if (want > AFE_MAX_GAIN)
+      want = AFE_MAX_GAIN;
+    if (want < AFE_MIN_GAIN)
+      want = AFE_MIN_GAIN;
+    int32_t diff = (int32_t)want - gainStart;
+    gainEnd += diff >> (diff < 0 ? AFE_ATTACK_SHIFT : AFE_RELEASE_SHIFT);
+  }
+
+  // Limiter: bloğun tepesi tavanı aşmasın (bloğun tamamı önceden bilindiği
+  // için kazanç, tepe örneğine gelmeden düşürülmüş olur)
+  if (peak16 > 0) {
+    int64_t ceiling = ((int64_t)AFE_LIMIT << 16) / peak16;
+    if (gainEnd > ceiling || gainStart > ceiling) {
+      if (gainEnd > ceiling)
+        gainEnd = (int32_t)ceiling;
+      if (gainStart > gainEnd)
+        gainStart = gainEnd;
+      fe.limited++;
+    }
+  }
+  fe.gain = gainEnd;
+
+  // --- Geçiş 2: kazanç rampası + 24 -> 16 bit ---
+  int32_t g = gainStart;
+  int32_t step = (gainEnd - gainStart) / n;
+  for (int i = 0; i < n; i++) {
+    out[i] = afeSaturate16(((int64_t)fe.work[i] * g) >> 24);
+    g += step;
+  }
+}
+
+// DC/HPF geçmişini sıfırlar, AGC kazancı korunur. Blok atlanmış ya da
+// akış geriye sarılmışsa (ön kayıt) eski durum geçici bir tık üretir.
+// first: yeni akışın ilk ham örneği (DC engelleyici sıçramasın diye)
+inline void afeResetFilters(AudioFrontEnd &fe, int32_t first) {
+  fe.dcX1 = first >> 8;
+  fe.dcY1 = 0;
+  fe.x1 = fe.x2 = fe.y1 = fe.y2 = 0;
+}
+
+// Son bloğun sonundaki AGC kazancı (doğrusal, 24 -> 16 bit dönüşümü hariç)
+inline float afeGain(const AudioFrontEnd &fe) {
+  return (float)fe.gain / AFE_GAIN_UNITY;
+}
+
+// Ölçülen işlemci yükü (%), cpuHz: çekirdek frekansı
+inline float afeCpuPercent(const AudioFrontEnd &fe, int blockLen,
+                           int sampleRate, uint32_t cpuHz) {
+  if (fe.blocks == 0)
+    return 0.0f;
+  double audioSec = (double)fe.blocks * blockLen / sampleRate;
+  return (float)(100.0 * (double)fe.cycles / (audioSec * cpuHz));
+}
+
+#endif // AUDIO_FRONTEND_H
@@ -0,0 +1,135 @@
+#ifndef AUDIO_PIPELINE_H
+#define AUDIO_PIPELINE_H
+
+// ============================================
+//  ORTAK SES HATTI (tüm sketch'ler)
+// ============================================
+//  Kart bağlantısı, I2S yapılandırması ve örnek dönüşümü tek yerde.
+//  AudioPipeline<Aygıt, Hız, Blok>: aygıt bir tip olduğu için dönüşüm ve
+//  RMS çekirdekleri derlemede özelleşir; döngü içinde biçim kontrolü yok.
+//
+//  INMP441 24-bit veriyi 32-bit kelimenin üst bitlerine yazar:
+//    PCM16  : s >> 16  (STT, wake word, kayıt)
+//    Seviye : s >> 14  (RMS; WAKE_THRESHOLD gibi eşikler bu ölçekte)
+//
+//  Bağlantı (ESP32-S3 DevKit):
+//    INMP441   → VDD:3.3V, GND, SD:GPIO4, WS:GPIO5, SCK:GPIO6, L/R:GND
+//    MAX98357A → VIN:3.3V, GND, DIN:GPIO8, BCLK:GPIO9, LRC:GPIO10
+
+#include <driver/i2s.h>
+#include <math.h>
+#include <stdint.h>
+
+constexpr int MIC_WS_PIN = 5;
+constexpr int MIC_SCK_PIN = 6;
+constexpr int MIC_SD_PIN = 4;
+constexpr i2s_port_t MIC_PORT = I2S_NUM_0;
+
+constexpr int SPK_BCLK_PIN = 9;
+constexpr int SPK_LRC_PIN = 10;
+constexpr int SPK_DIN_PIN = 8;
+constexpr i2s_port_t SPK_PORT = I2S_NUM_1;
+
+constexpr int SAMPLE_RATE = 16000;
+constexpr int BUFFER_LENGTH = 512; // Okuma bloğu = varsayılan DMA tampon boyu
+constexpr int AUDIO_DMA_BUF_COUNT = 8;
+
+// INMP441 mikrofon: 32-bit kelime, sol kanal (L/R = GND)
+struct Inmp441Mic {
+  typedef int32_t Sample;
+  static constexpr i2s_mode_t DIRECTION = I2S_MODE_RX;
+  static constexpr i2s_bits_per_sample_t BITS = I2S_BITS_PER_SAMPLE_32BIT;
+  static inline int16_t pcm16(int32_t s) { return (int16_t)(s >> 16); }
+  static inline int32_t level(int32_t s) { return s >> 14; }
+  static i2s_pin_config_t pins() {
+    i2s_pin_config_t p = {.bck_io_num = MIC_SCK_PIN,
+                          .ws_io_num = MIC_WS_PIN,
+                          .data_out_num = I2S_PIN_NO_CHANGE,
+                          .data_in_num = MIC_SD_PIN};
+    return p;
+  }
+};
+
+// MAX98357A amfi: 16-bit PCM, mono
+struct Max98357Speaker {
+  typedef int16_t Sample;
+  static constexpr i2s_mode_t DIRECTION = I2S_MODE_TX;
+  static constexpr i2s_bits_per_sample_t BITS = I2S_BITS_PER_SAMPLE_16BIT;
+  static inline int16_t pcm16(int16_t s) { return s; }
+  static inline int32_t level(int16_t s) { return (int32_t)s << 2; }
+  static i2s_pin_config_t pins() {
+    i2s_pin_config_t p = {.bck_io_num = SPK_BCLK_PIN,
+                          .ws_io_num = SPK_LRC_PIN,
+                          .data_out_num = SPK_DIN_PIN,
+                          .data_in_num = I2S_PIN_NO_CHANGE};
+    return p;
+  }
+};
+
+template <class Device, int Rate, int Block> struct AudioPipeline {
+  typedef typename Device::Sample Sample;
+  static constexpr int RATE = Rate;
+  static constexpr int BLOCK = Block;
+  static constexpr size_t BLOCK_BYTES = Block * sizeof(Sample);
+
+  // Blok RMS'i (seviye ölçeğinde). step > 1: her step'inci örnek (seyreltme;
+  // eşik karşılaştırması için yeterli, iş step kat azalır)
+  static inline float rms(const Sample *buf, int n, int step = 1) {
+    int64_t sum = 0;
+    int count = 0;
+    for (int i = 0; i < n; i += step) {
+      int32_t s = Device::level(buf[i]);
+      sum += (int64_t)s * s;
+      count++;
+    }
+    return count > 0 ? sqrtf((float)sum / count) : 0.0f;
+  }
+
+  static inline int16_t pcm16(Sample s) { return Device::pcm16(s); }
+
+  static inline void toPcm16(const Sample *in, int16_t *out, int n) {
+    for (int i = 0; i < n; i++)
+      out[i] = Device::pcm16(in[i]);
+  }
+
+  static i2s_config_t i2sConfig(int dmaBufCount = AUDIO_DMA_BUF_COUNT,
+                                int dmaBufLen = Block) {
+    i2s_config_t cfg = {
+        .mode = (i2s_mode_t)(I2S_MODE_MASTER | Device::DIRECTION),
+        .sample_rate = Rate,
+        .bits_per_sample = Device::BITS,
+        .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+        .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+        .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
+        .dma_buf_count = dmaBufCount,
+        .dma_buf_len = dmaBufLen,
+        .use_apll = false,
+        // TX boşalınca sessizlik çalsın
+        .tx_desc_auto_clear = Device::DIRECTION == I2S_MODE_TX,
+        .fixed_mclk = 0};
+    return cfg;
+  }
+
+  static i2s_pin_config_t pins() { return Device::pins(); }
+
+  // Basit sketch'ler için tek çağrıda kurulum; hata kodunu döner
+  static esp_err_t install(i2s_port_t port,
+                           int dmaBufCount = AUDIO_DMA_BUF_COUNT,
+                           int dmaBufLen = Block) {
+    i2s_config_t cfg = i2sConfig(dmaBufCount, dmaBufLen);
+    i2s_pin_config_t p = pins();
+    esp_err_t err = i2s_driver_install(port, &cfg, 0, NULL);
+    if (err != ESP_OK)
+      return err;
+    err = i2s_set_pin(port, &p);
+    if (err != ESP_OK)
+      return err;
+    return i2s_zero_dma_buffer(port);
+  }
+};
+
+typedef AudioPipeline<Inmp441Mic, SAMPLE_RATE, BUFFER_LENGTH> MicAudio;
+typedef AudioPipeline<Max98357Speaker, SAMPLE_RATE, BUFFER_LENGTH>
+    SpeakerAudio;
+
+#endif // AUDIO_PIPELINE_H
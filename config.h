@@ -21,4 +21,34 @@
 // Kod içinde {event} kısmı eylem adıyla (örn. light_on) değiştirilecektir.
 #define SMART_HOME_WEBHOOK_URL "YOUR_WEBHOOK_URL_HERE"
 
+// Akıllı Ev Entegrasyonu (MQTT) — ayarlanırsa önce bu denenir, webhook yedek.
+// Komut: MQTT_TOPIC_PREFIX + cihaz + "/set" konusuna eylem adı (örn. turn_on)
+// Yerel test: `mosquitto -v` çalıştır, `mosquitto_sub -t 'alex/#' -v` ile izle.
+#define MQTT_BROKER_HOST "YOUR_MQTT_BROKER_HERE"
+#define MQTT_BROKER_PORT 1883
+#define MQTT_USER ""
+#define MQTT_PASSWORD ""
+#define MQTT_TOPIC_PREFIX "alex/"
+// Cihaz durumu (isteğe bağlı): MQTT_TOPIC_PREFIX + cihaz + MQTT_STATE_SUFFIX
+// konusuna "ON"/"OFF" yayınlanırsa (örn. bir Home Assistant otomasyonuyla)
+// durum önbelleği güncellenir. Boş bırakılırsa abone olunmaz.
+#define MQTT_STATE_SUFFIX "/state"
+
+// Akıllı ev cihazları: "kimlik=Konuşmadaki ad" çiftleri, ';' ile ayrılır.
+// Kimlik MQTT konusunda / webhook olayında kullanılır ve Gemini'ye işlev
+// bildirimi olarak gönderilir. İlk açılışta (ve liste değişince) NVS'e yazılır.
+#define SMART_HOME_DEVICES                                                     \
+  "living_room_light=Salon ışığı;kitchen_socket=Mutfak prizi"
+
+// Akışlı STT köprüsü (isteğe bağlı) — Google streamingRecognize gRPC istediği
+// için cihaz, düz TCP satır protokolünü gRPC'ye çeviren bir köprüye bağlanır.
+// Protokol için delican.cpp'de "AKIŞLI STT" bölümüne bak. Ayarlanmazsa
+// kayıt sessizlikle biter ve speech:recognize kullanılır.
+#define STREAM_STT_HOST "YOUR_STREAM_BRIDGE_HERE"
+#define STREAM_STT_PORT 8765
+
+// Uyanma modeli güncelleme parolası (PUT /wake-model, "X-Token" başlığı).
+// Boş bırakılırsa yükleme sunucusu hiç başlatılmaz.
+#define WAKE_MODEL_TOKEN ""
+
 #endif // CONFIG_H
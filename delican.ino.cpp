@@ -9,6 +9,7 @@
  *
  *  Gerekli kütüphane:
  *   - ArduinoJson (Library Manager'dan kur)
+ *   - PubSubClient (MQTT ile akıllı ev kontrolü için)
  *
  *  Bağlantı:
  *   INMP441 → VDD:3.3V, GND, SD:GPIO4, WS:GPIO5, SCK:GPIO6, L/R:GND
@@ -16,16 +17,26 @@
  * ============================================
  */
 
+#include <Adafruit_NeoPixel.h>
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
 #include <Preferences.h> // Kalıcı hafıza için
+#include <PubSubClient.h> // MQTT (akıllı ev)
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #include <WiFiManager.h> // WiFi Manager kütüphanesi (tzapu)
 #include <driver/i2s.h>
 
+#include "audio_frontend.h"
+#include "audio_pipeline.h"
 #include "config.h"
+#include "earcons.h"
+#include "keyword_recognizer.h"
+#include "local_tts.h"
+#include "metrics.h"
+#include "noise_suppressor.h"
+#include "wake_model.h"
 
 // ============================================
 //  WAKE WORD AYARLARI (ESP-SR)
@@ -33,6 +44,32 @@
 // Eğer kütüphane yüklü değilse bu satırı yorum satırı yapın:
 // #define USE_WAKE_WORD
 
+// Spektral gürültü bastırma (fan, TV vb.). Kapatmak için yorum satırı yapın.
+#define USE_NOISE_SUPPRESSION
+
+// Sık kullanılan akıllı ev komutlarını cihazda tanı (MFCC + DTW). Şablonlar,
+// bulutun tek eylem olarak anladığı komutların kaydından kendiliğinden
+// öğrenilir; eşleşirse STT ve Gemini hiç çağrılmaz (internetsiz de çalışır).
+// Kayıtlı bir derlemde tools/kws_harness.cpp ile doğrulanana kadar kapalı:
+// STT'den önce çalışır ve yanlış kabul doğrudan cihaz komutu demektir.
+// #define USE_LOCAL_COMMANDS
+
+// Dinlemeye / düşünmeye geçişte anında kısa efekt sesi (bkz. earcons.h).
+// EARCON_THINKING_LOOP: cevap gelene kadar kısık sesli aralıklı "tık".
+#define USE_EARCONS
+#define EARCON_THINKING_LOOP
+
+// Filo izleme: http://<cihaz>:9100/metrics (Prometheus metin formatı)
+#define USE_METRICS
+#define METRICS_PORT 9100
+#define METRICS_MAX_TASKS 32
+
+// Uyanma modeli uygulamaya gömülmez: "wakemodel" flash bölümünden eşlenir
+// (wake_model.h) ve ağdan, uygulama yeniden yüklenmeden güncellenir.
+#define USE_WAKE_MODEL_PARTITION
+#define WAKE_MODEL_PORT 9101
+#define WAKE_MODEL_CHUNK 1024
+
 #ifdef USE_WAKE_WORD
 #include <ESP_I2S.h>
 #include <dl_lib_coefgetter_if.h>
@@ -40,29 +77,107 @@
 #include <esp_wn_models.h>
 #endif
 
-// ============================================
-//  PIN TANIMLAMALARI
-// ============================================
-#define MIC_WS_PIN 5
-#define MIC_SCK_PIN 6
-#define MIC_SD_PIN 4
-#define MIC_PORT I2S_NUM_0
-
-#define SPK_BCLK_PIN 9
-#define SPK_LRC_PIN 10
-#define SPK_DIN_PIN 8
-#define SPK_PORT I2S_NUM_1
-
 // ============================================
 //  SABİTLER
 // ============================================
-#define SAMPLE_RATE 16000
-#define BUFFER_LENGTH 512
-#define MAX_RECORD_SAMPLES (SAMPLE_RATE * 5)
+// Pinler, SAMPLE_RATE ve BUFFER_LENGTH: audio_pipeline.h
+#define RECORD_MAX_SECONDS 45 // Senkron STT en fazla 60 sn kabul eder
+#define MAX_RECORD_SAMPLES (SAMPLE_RATE * RECORD_MAX_SECONDS)
+#define RECORD_BLOCK_BYTES 16384   // PSRAM blok boyutu (16-bit'te 0.5 sn)
+#define RECORD_PREALLOC_BLOCKS 4   // Açılışta ayrılan bloklar
+// μ-law (G.711) ile sakla: yarı bellek, yarı yükleme. Google STT "MULAW"
+// kodlamasını doğrudan kabul eder, ancak 8-bit nicemleme tanıma doğruluğunu
+// düşürebilir; kendi komut setinizle LINEAR16'ya karşı ölçmeden açmayın.
+// #define RECORD_MULAW
 #define WAKE_THRESHOLD 1500
 #define WAKE_CONFIRM_MS 300
 #define SILENCE_TIMEOUT_MS 1500
 
+// Düşük güçlü bekleme: IDLE'da CPU düşük saatte, Wi-Fi modem uykusunda;
+// enerji seyreltilmiş örneklerden ölçülür, ön işleme ara sıra çalışır. Ham
+// ses ön kayıt halkasında tutulur, uyanınca işlenip kaydın başına eklenir
+// (tetikleyen hece kaybolmaz).
+#define USE_LOW_POWER_IDLE
+#define IDLE_CPU_MHZ 80 // Wi-Fi için en düşük
+#define ACTIVE_CPU_MHZ 240
+#define IDLE_RMS_DECIMATION 4   // Her 4. örnek
+#define IDLE_FULL_BLOCK_EVERY 8 // AGC + gürültü profili için tam işlenen blok
+#define PRE_ROLL_MS 500         // WAKE_CONFIRM_MS'ten uzun olmalı
+// Akım tahmini (mA, kartın tamamı). Ölçülmüş değer yok: kendi kartınızda
+// USB ölçerle ölçüp girin. İkisi de girilince /metrics bunları mod
+// sürelerine göre ağırlıklandırır; 0 iken tahmin yayınlanmaz.
+#define IDLE_CURRENT_MA 0
+#define ACTIVE_CURRENT_MA 0
+
+// Kısa bir duraklamada kayıt (dinlemeye devam edilirken) arka planda STT'ye
+// gönderilir. Sessizlik SILENCE_TIMEOUT_MS'e ulaşırsa bu sonuç kullanılır,
+// konuşma sürerse atılır ve tam kayıt gönderilir.
+#define USE_SPECULATIVE_STT
+#define STT_SPECULATIVE_PAUSE_MS 300
+#define STT_SPECULATIVE_MIN_MS 500     // Daha kısa kayıt gönderilmez
+#define STT_SPECULATIVE_TIMEOUT_MS 8000
+#define STT_SPECULATIVE_STACK 8192
+#define STT_SPECULATIVE_MIN_HEAP 65536 // Kendi TLS oturumu ~40 KB iç RAM
+#define STT_SPECULATIVE_DROP_WAIT_MS 200 // Vazgeçilen isteğin kesilmesi
+
+// Akışlı tanıma: kayıt sürerken ses bir köprüye (config.h, STREAM_STT_HOST)
+// gönderilir, konuşma sonunu sunucu bildirir. Köprü ayarlı değilse ya da
+// bağlantı koparsa RMS sessizliği + speech:recognize yedektir.
+#define USE_STREAMING_STT
+#define STREAM_STT_FRAME_BYTES 640       // 40 ms μ-law
+#define STREAM_STT_POLL_MS 20
+#define STREAM_STT_CONNECT_TIMEOUT_MS 2000
+#define STREAM_STT_FINAL_TIMEOUT_MS 3000 // Ses bittikten sonra son sonuç
+#define STREAM_STT_DISCARD_WAIT_MS 200 // Vazgeçilen oturumun kapanması
+#define STREAM_STT_STACK 8192
+
+// Takip modu: cevap bittikten sonra tekrar tetiklemeden dinlemeye geç.
+// Kapatmak için yorum satırı yapın.
+#define USE_FOLLOW_UP
+#define FOLLOW_UP_WINDOW_MS 5000 // Bu sürede konuşma başlamazsa IDLE
+#define PLAYBACK_TAIL_MS 300     // Kendi sesimizin yankısı için yoksayma
+
+// Yerel formant TTS (local_tts.h): onaylar ve bağlantı yokken kullanılır
+#define LOCAL_TTS_MAX_CHARS 120 // Daha uzun metinler yerelde okunmaz
+
+// Uzun cevaplar cümle sınırlarından parçalara bölünür; parça N çalma
+// motorunda çalarken N+1 sentezlenir (çift tampon). İlk parça kısa tutulur.
+#define GEMINI_MAX_ANSWER_CHARS 1500
+#define TTS_FIRST_CHUNK_CHARS 60
+#define TTS_CHUNK_MAX_CHARS 100 // ~7 sn ses, bulut TTS tamponuna sığar
+#define TTS_MAX_CHUNKS 24
+
+// Tur süresi tavanı: kayıt bitişinden ilk sese kadar. Kalan süre, kalan
+// aşamalara ağırlıklarıyla bölünür; erken biten aşamanın payı sonrakilere
+// kalır. Süre dolarsa yerel sentezle kısa bir özür okunur.
+#define TURN_DEADLINE_MS 15000
+#define TURN_WEIGHT_STT 3
+#define TURN_WEIGHT_LLM 4
+#define TURN_WEIGHT_TTS 3
+#define TURN_MIN_STAGE_MS 1500     // Daha az kaldıysa aşama başlatılmaz
+#define TTS_CHUNK_TIMEOUT_MS 10000 // İlk sesten sonraki parçalar
+#define TURN_APOLOGY "Üzgünüm, şu an cevap veremiyorum."
+
+// Gemini isteği geçmiş p95 süresini aşarsa aynı istek ikinci bir TLS
+// bağlantısından da gönderilir; ilk gelen cevap kullanılır.
+#define USE_HEDGING
+#define HEDGE_PERCENTILE 95
+#define HEDGE_MIN_SAMPLES 20 // Histogramda bundan az örnek varsa hedge yok
+#define HEDGE_TASK_STACK 12288
+#define HEDGE_MIN_FREE_HEAP 65536 // İkinci TLS oturumu ~40 KB iç RAM ister
+#define HEDGE_MIN_HEAP_BLOCK 17408 // mbedTLS 16 KB giriş tamponu tek parça
+
+#define KWS_MAX_TEMPLATES 16
+#define KWS_TEMPLATES_PER_COMMAND 2 // Aynı komut/cihaz için en fazla örnek
+#define KWS_TEMPLATE_MAX_FRAMES 200 // 2 sn konuşma (kırpılmış)
+// Eşikler tools/kws_harness.cpp taramasından (sentetik derlem, çöp yanlış
+// kabulü sıfır): "salon ışığı açık mı" %85 payla "salon ışığını aç" sayılıyordu
+#define KWS_ACCEPT_DIST 400         // DTW mesafesi (Q8, L1) bunun altındaysa
+#define KWS_MARGIN_PCT 65 // ...ve en yakın başka komutun %65'inden küçükse
+#define KWS_FILLER_PCT 70 // ...ve ortalama konuşmaya (çöp) mesafenin %70'i
+#define KWS_MIN_COMMANDS 2 // Rakipsiz eşleşme kabul edilmez
+#define KWS_NVS_MAX_BYTES 12288 // 20 KB nvs bölümü Wi-Fi/ayarlarla paylaşılır
+
 #define STT_URL_BASE "https://speech.googleapis.com/v1/speech:recognize?key="
 #define TTS_URL_BASE                                                           \
   "https://texttospeech.googleapis.com/v1/text:synthesize?key="
@@ -70,6 +185,11 @@
   "https://generativelanguage.googleapis.com/v1beta/models/"                   \
   "gemini-1.5-flash:generateContent?key="
 
+// Ağ ısındırma (warm-up) için sunucu adları — URL'lerle aynı olmalı
+#define STT_HOST "speech.googleapis.com"
+#define TTS_HOST "texttospeech.googleapis.com"
+#define LLM_HOST "generativelanguage.googleapis.com"
+
 // Not: URL'leri dinamik oluşturacağız, bu yüzden String birleştirme yapacağız.
 
 // ============================================
@@ -82,14 +202,241 @@ typedef enum {
   STATE_SPEAKING
 } SystemState;
 
-SystemState currentState = STATE_IDLE;
+// LED görevi de okur; 32-bit hizalı okuma/yazma atomiktir
+volatile SystemState currentState = STATE_IDLE;
 
 // ============================================
 //  GLOBAL DEĞİŞKENLER
 // ============================================
 int32_t rawBuffer[BUFFER_LENGTH];
-int16_t *recordBuffer = nullptr;
-int recordIndex = 0;
+
+// ============================================
+//  BELLEK TELEMETRİSİ (dahili heap + PSRAM)
+// ============================================
+// Uygulamanın büyük ayırmaları memTrackAlloc() üzerinden yapılır ve o anki
+// duruma (aşama) yazılır. Her setState() geçişinde bir örnek halkaya eklenir.
+// Parçalanma: 1 - (en büyük boş blok / toplam boş). Eşiği geçince uyarı.
+#define MEM_RING_LEN 32
+#define MEM_FRAG_ALERT_PCT 60   // Bu yüzdenin üstü parçalanma uyarısı
+#define MEM_FRAG_CLEAR_PCT 45   // Uyarı bunun altına inince kalkar
+#define MEM_FRAG_MIN_FREE 16384 // Daha az boş bellekte oran anlamsız
+#define MEM_HISTORY_ON_FAIL 8   // Ayırma hatasında dökülen son örnek
+
+struct MemStageStats {
+  uint32_t allocs;
+  uint32_t failures;
+  uint32_t bytes; // İstenen toplam
+  uint32_t largestRequest;
+  uint32_t minFreeHeap; // Aşama boyunca görülen en düşük (tepe kullanım)
+  uint32_t minFreePsram;
+  uint32_t minLargestHeap; // En küçük "en büyük boş blok"
+  uint32_t minLargestPsram;
+};
+
+struct MemSample {
+  uint32_t at; // millis()
+  uint8_t from;
+  uint8_t to;
+  uint32_t freeHeap;
+  uint32_t largestHeap;
+  uint32_t freePsram;
+  uint32_t largestPsram;
+};
+
+MemStageStats memStages[4]; // SystemState başına
+MemSample memRing[MEM_RING_LEN];
+uint16_t memRingHead = 0;
+uint32_t memSampleCount = 0;
+bool memFragAlert[2] = {false, false}; // [0] heap, [1] PSRAM
+
+void memTelemetryInit();
+void *memTrackAlloc(size_t bytes, bool psram, const char *tag);
+void memSample(uint8_t from, uint8_t to);
+void memReport();
+
+// ============================================
+//  PARÇALI KAYIT DEPOSU (PSRAM blok zinciri)
+// ============================================
+// Tek parça büyük tampon yerine sabit boyutlu blokların bağlı listesi.
+// Boşalan bloklar serbest listede tutulur (PSRAM parçalanmasın).
+struct RecordBlock {
+  RecordBlock *next;
+  size_t used;
+  uint8_t data[RECORD_BLOCK_BYTES];
+};
+
+struct RecordStore {
+  RecordBlock *head;
+  RecordBlock *tail;
+  RecordBlock *freeList;
+  size_t samples;
+  uint16_t blocksInUse;
+  uint16_t blocksAllocated;
+};
+RecordStore recordStore = {NULL, NULL, NULL, 0, 0, 0};
+
+bool recordStoreInit();
+void recordClear();
+bool recordAppend(const int16_t *pcm, int n);
+size_t recordSampleCount() { return recordStore.samples; }
+
+// ============================================
+//  I2S DMA PROFİLLERİ & SAĞLIK İZLEME
+// ============================================
+// Küçük DMA = düşük gecikme, büyük DMA = takılmaya dayanıklı. Profil
+// açılışta port başına seçilir; çalışırken değiştirilmez (hoparlör sürücüsü
+// çalma görevi i2s_write içindeyken yeniden kurulamaz).
+struct AudioProfile {
+  const char *name;
+  int dmaBufCount;
+  int dmaBufLen; // Örnek (frame) sayısı, en fazla 1024
+};
+const AudioProfile AUDIO_PROFILE_ROBUST = {"sağlam", 8, BUFFER_LENGTH};
+// Çalma motoru DMA'yı ayrı görevden beslediği için hoparlörde küçük bloklar
+// yeterli: efekt sesi 1-2 blok (8-16 ms) içinde duyulur, halka 64 ms.
+const AudioProfile AUDIO_PROFILE_RESPONSIVE = {"hızlı tepki", 8, 128};
+
+#define MIC_AUDIO_PROFILE AUDIO_PROFILE_ROBUST
+#define SPK_AUDIO_PROFILE AUDIO_PROFILE_RESPONSIVE
+#define I2S_EVENT_QUEUE_LEN 16
+
+struct AudioPortHealth {
+  i2s_port_t port;
+  const char *name;
+  QueueHandle_t events;  // i2s_driver_install'ın doldurduğu olay kuyruğu
+  AudioProfile profile;
+  volatile uint32_t overflows;  // RX: okunmadan üzerine yazılan DMA bloğu
+  volatile uint32_t underruns;  // TX: çalarken boşalan DMA kuyruğu
+  volatile uint32_t dmaErrors;
+  uint32_t reportedTotal;
+};
+AudioPortHealth micHealth = {MIC_PORT, "Mikrofon", NULL,
+                             MIC_AUDIO_PROFILE, 0, 0, 0, 0};
+AudioPortHealth spkHealth = {SPK_PORT, "Hoparlör", NULL,
+                             SPK_AUDIO_PROFILE, 0, 0, 0, 0};
+
+// Sadece çalarken oluşan TX kuyruk taşmaları gerçek underrun'dır
+volatile bool playbackActive = false;
+
+// ============================================
+//  ÇALMA MOTORU (ayrı görev + tampon kuyruğu)
+// ============================================
+// Üreticiler (TTS, önbellek, efekt sesleri) tamponu kuyruğa atıp hemen
+// döner; motor görevi DMA'yı besler. Parçalar arasında kuyruk boş kalırsa
+// DMA kurumadan sessizlik yazılır; arkasından gecikmiş bir tampon gelirse
+// bu bir underrun sayılır.
+#define PLAYBACK_QUEUE_LEN 8
+#define PLAYBACK_STACK 4096
+#define PLAYBACK_GAP_FILL_MS 250  // Tampon bitince en fazla bu kadar sessizlik
+#define PLAYBACK_PROGRESS_MS 100  // İlerleme geri çağırma aralığı
+#define EARCON_GAIN_Q15 32767      // Tek seferlik efektler
+#define EARCON_LOOP_GAIN_Q15 6554  // Düşünme döngüsü: -14 dB
+#define EARCON_LOOP_GAP_MS 700
+
+// done=true: tampon bitti ya da durduruldu (played < total)
+typedef void (*PlaybackCallback)(uint32_t id, size_t played, size_t total,
+                                 bool done, void *ctx);
+
+struct PlaybackItem {
+  int16_t *pcm;
+  size_t samples;
+  bool owned; // true: çalındıktan sonra motor free() eder
+  uint32_t id;
+  uint32_t generation; // playbackStop() eski nesli geçersiz kılar
+  PlaybackCallback cb;
+  void *ctx;
+};
+
+struct PlaybackStats {
+  uint32_t buffers;
+  uint32_t stopped;
+  uint32_t underruns;     // Sessizlik doldururken gelen (geç kalmış) tampon
+  uint32_t silenceBlocks; // DMA'ya yazılan dolgu bloğu
+  uint32_t reportedUnderruns;
+};
+
+QueueHandle_t playbackQueue = NULL;
+portMUX_TYPE playbackMux = portMUX_INITIALIZER_UNLOCKED;
+volatile uint32_t playbackPending = 0; // Kuyrukta + çalınmakta olan
+volatile uint32_t playbackGeneration = 0;
+uint32_t playbackNextId = 1;
+PlaybackStats playbackStats = {0, 0, 0, 0, 0};
+
+// Karıştırıcıdaki efekt sesi: bir kez çalınan ses + isteğe bağlı döngü.
+// Ana görev isteği earconRequest'e yazar, motor blok başında devralır.
+struct EarconVoice {
+  const Earcon *sound;     // Şu an çalan (NULL: sessiz)
+  const Earcon *loopSound; // Bitince aralıklı tekrarlanır (NULL: yok)
+  int32_t gain;            // Q15
+  int32_t loopGain;
+  uint32_t pos;
+  uint32_t gapLeft; // Döngü tekrarları arası kalan sessizlik (örnek)
+  AdpcmState adpcm;
+};
+EarconVoice earconRequest;
+volatile bool earconRequestPending = false;
+
+void earconPlay(const Earcon *sound, const Earcon *loopSound = NULL);
+void earconStop();
+
+void playbackInit();
+uint32_t playbackEnqueue(int16_t *pcm, size_t samples, bool owned,
+                         PlaybackCallback cb = NULL, void *ctx = NULL);
+void playbackStop();
+bool playbackFlush(uint32_t timeoutMs = 60000);
+bool playbackWaitPending(uint32_t maxPending, uint32_t timeoutMs = 60000);
+
+void audioHealthReport();
+void playbackReport();
+float audioPortDelayMs(const AudioPortHealth &h);
+
+// Kayıt yolu ön işleme (DC + HPF + AGC), bkz. audio_frontend.h
+AudioFrontEnd frontEnd;
+int16_t frontEndBuffer[BUFFER_LENGTH];
+void frontEndReport();
+
+#ifdef USE_NOISE_SUPPRESSION
+NoiseSuppressor noiseSuppressor; // Gürültü IDLE'da öğrenilir
+#endif
+
+#ifdef USE_LOCAL_COMMANDS
+// ============================================
+//  YEREL KOMUT ŞABLONLARI (NVS + PSRAM)
+// ============================================
+struct KwsTemplate {
+  char cmd[32];
+  char device[48];
+  char speech[96]; // Bulutun verdiği onay cümlesi (sığmazsa boş)
+  uint16_t frames;
+  KwsVector data[KWS_TEMPLATE_MAX_FRAMES]; // NVS'e sadece frames kadarı yazılır
+};
+
+struct KwsWorkspace {
+  KwsExtractor ex;
+  KwsFeatures utterance; // Son kaydın özellikleri (öğrenme için saklanır)
+  bool utteranceValid;
+  int32_t dtwRow[2 * (KWS_TEMPLATE_MAX_FRAMES + 1)];
+  int16_t pcm[256]; // μ-law çözme tamponu
+};
+
+struct KwsStats {
+  uint32_t attempts;
+  uint32_t hits;
+  uint32_t enrolled;
+  uint32_t lastFeatureUs; // Son ifade: özellik çıkarma
+  uint32_t lastDtwUs;     // Son ifade: şablon karşılaştırma
+};
+
+KwsTables kwsTables;
+KwsWorkspace *kws = NULL;          // PSRAM
+KwsTemplate *kwsTemplates = NULL;  // PSRAM, KWS_MAX_TEMPLATES adet
+int kwsTemplateCount = 0;
+KwsStats kwsStats = {0, 0, 0, 0, 0};
+
+bool kwsStoreInit();
+const KwsTemplate *kwsRecognize();
+void kwsEnroll(const String &cmd, const String &device, const String &speech);
+#endif
 
 // ============================================
 //  FONKSİYON PROTOTİPLERİ (Forward Declarations)
@@ -100,16 +447,86 @@ void wifi_connect();
 void setState(SystemState s);
 void processVoiceCommand();
 String speechToText();
-String askGemini(const String &userText);
-void textToSpeech(const String &text);
-void playAudio(int16_t *audioData, size_t sampleCount);
-float calculateRMS(int samplesRead);
+String sttRequest(size_t audioBytes, uint32_t timeoutMs);
+String sttPost(WiFiClientSecure &client, size_t audioBytes,
+               unsigned long deadline, const volatile bool *cancel);
+void textToSpeech(const String &text, bool preferLocal = false);
+bool cloudTextToSpeech(const String &text);
+bool localTextToSpeech(const String &text);
+int16_t *cloudTtsFetch(const String &text, size_t &samples);
+int16_t *localTtsRender(const String &text, size_t &samples);
+int ttsSplitChunks(const String &text, String *chunks, int maxChunks);
+int ttsBreakPoint(const String &text, int limit);
 bool detectWakeWord(int32_t *buffer, size_t length);
 
 unsigned long wakeStartTime = 0;
 unsigned long lastSoundTime = 0;
 bool soundDetected = false;
 
+// Takip modu durumu
+bool followUpActive = false;
+bool followUpHeard = false;       // Pencerede konuşma başladı mı
+unsigned long followUpDeadline = 0;
+unsigned long followUpIgnoreUntil = 0; // Hoparlör kuyruğu + yankı
+bool wakeChimeSkip = false; // RMS tetiği: kullanıcı zaten konuşuyor, ses yok
+uint32_t followUpTurns = 0;
+void finishTurn();
+
+// Spekülatif STT: görev core 0'da, sonuç ana döngüde (core 1) okunur
+struct SttSpeculation {
+  TaskHandle_t task;
+  SemaphoreHandle_t done; // Her istek bitince verilir
+  volatile bool busy;     // Görev istek gönderiyor
+  volatile bool cancel;   // Sonuç gerekmiyor: yükleme/okuma kesilir
+  bool pending;           // Bu kayıt için gönderildi, karar verilmedi
+  unsigned long lastSound; // Gönderildiği andaki lastSoundTime
+  unsigned long sentAt;
+  size_t bytes;            // Gönderilen ses baytı (kayıt başından)
+  String transcript;       // busy false olunca geçerli
+  uint32_t sent;
+  uint32_t used;
+  uint32_t wasted; // Konuşma sürdü ya da yerel komut eşleşti
+  uint32_t failed; // Kullanılacaktı ama boş/hatalı döndü
+  unsigned long savedMs; // Kullanılanlarda sessizlik sonundan önce kazanılan
+};
+SttSpeculation sttSpec = {NULL,  NULL, false, false, false, 0, 0,
+                          0,     "",   0,     0,     0,     0, 0};
+// Spekülatif isteğin kendi bağlantısı: paylaşılan STT kilidini tutmaz,
+// tam kayıt isteği onun arkasında beklemez
+WiFiClientSecure sttSpecClient;
+
+void sttSpecInit();
+void sttSpecPoll();
+bool sttSpecTake(String &transcript);
+void sttSpecDrop();
+void sttSpecDiscard();
+
+// Akışlı STT oturumu: görev core 0'da sesi gönderir ve cevapları okur
+struct SttStream {
+  TaskHandle_t task;
+  SemaphoreHandle_t done;     // Oturum bitince verilir
+  volatile bool active;       // Görev bu kayıt için çalışıyor
+  volatile bool stop;         // Ana döngü: ses gönderimini bitir
+  volatile bool cancel;       // Kayıt siliniyor: sonucu beklemeden çık
+  volatile bool endOfUtterance; // Sunucu konuşmanın bittiğini bildirdi
+  volatile bool failed;
+  volatile bool finalReady;
+  String finalText; // active false olunca geçerli
+  unsigned long startedAt;
+  uint32_t sessions;
+  uint32_t serverEnds; // Kayıt sunucunun konuşma sonu olayıyla bitti
+  uint32_t used;
+  uint32_t fallbacks; // Bağlantı/son sonuç yok, senkron STT'ye düşüldü
+};
+SttStream sttStream = {NULL,  NULL, false, false, false, false, false,
+                       false, "",   0,     0,     0,     0,     0};
+
+void sttStreamInit();
+void sttStreamBegin();
+bool sttStreamHealthy();
+bool sttStreamTake(String &transcript);
+bool sttStreamDiscard();
+
 // ============================================
 //  AYARLAR (NVS)
 // ============================================
@@ -137,9 +554,342 @@ int historyCount = 0;
 // ============================================
 #define LED_PIN 17 // Kullanıcı isteği üzerine GPIO 17
 #define LED_COUNT 1
+#define LED_FRAME_MS 20 // 50 FPS
 Adafruit_NeoPixel strip(LED_COUNT, LED_PIN, NEO_GRB + NEO_KHZ800);
 
-void handleLedEffects(); // Loop içinde çağrılacak
+// Çalma motoru her blokta günceller (0-255), SPEAKING efekti bunu izler
+volatile uint8_t playbackEnvelope = 0;
+
+void handleLedEffects(); // LED görevinden çağrılır
+void ledInit();
+
+// ============================================
+//  AĞ ISINDIRMA (Warm-up) & DNS ÖNBELLEĞİ
+// ============================================
+// LISTENING'e girilince STT/LLM/TTS sunucularına DNS + TLS bağlantısı arka
+// planda açılır; kullanıcı konuşmayı bitirdiğinde soketler hazır olur.
+#define DNS_CACHE_TTL_MS 300000     // 5 dk
+#define NET_HANDSHAKE_TIMEOUT_S 5   // TLS el sıkışma zaman aşımı
+#define NET_WARMUP_STACK 8192
+
+typedef enum {
+  NET_HOST_STT,
+  NET_HOST_LLM,
+  NET_HOST_TTS,
+  NET_HOST_COUNT
+} NetHost;
+
+typedef enum { WARM_IDLE, WARM_BUSY, WARM_READY, WARM_FAILED } WarmState;
+
+struct NetEndpoint {
+  const char *host;
+  IPAddress ip;
+  unsigned long dnsExpiresAt;
+  bool dnsValid;
+  WiFiClientSecure client;     // Turlar arasında açık kalan kalıcı soket
+  SemaphoreHandle_t lock;      // Warm-up görevi ile ana döngü arasında
+  volatile WarmState warm;
+};
+NetEndpoint netEndpoints[NET_HOST_COUNT];
+TaskHandle_t netWarmupTaskHandle = NULL;
+
+struct NetWarmStats {
+  uint32_t dnsHits;
+  uint32_t dnsMisses;
+  uint32_t ready;  // İhtiyaç anında bağlantı hazırdı
+  uint32_t late;   // Warm-up sürüyordu, bitmesi beklendi
+  uint32_t missed; // Warm-up hiç başlamamış / başarısız
+  uint32_t busy;   // Kilit süre içinde alınamadı, istek gönderilmedi
+};
+NetWarmStats netStats = {0, 0, 0, 0, 0, 0};
+
+void netWarmupInit();
+void netWarmupKick();
+WiFiClientSecure *netAcquire(NetHost h, uint32_t waitMs);
+void netRelease(NetHost h);
+void netWarmupReport();
+
+// ============================================
+//  AKILLI EV KUYRUĞU
+// ============================================
+// Webhook'lar ayrı bir görevde çalışır; onay konuşması beklemeden başlar.
+#define SMART_HOME_QUEUE_LEN 8
+#define SMART_HOME_WORKERS 2 // Çoklu eylemler paralel gönderilir
+#define SMART_HOME_MAX_ACTIONS 8 // Tek cümlede en fazla eylem
+#define SMART_HOME_MAX_ATTEMPTS 3
+#define SMART_HOME_BACKOFF_MS 250 // 250, 500, 1000 ms...
+#define SMART_HOME_TIMEOUT_MS 5000
+#define MQTT_RECONNECT_MS 5000   // Broker koparsa en sık bu aralıkla dene
+#define MQTT_LOOP_INTERVAL_MS 200 // Keep-alive için kuyruk bekleme süresi
+
+struct SmartHomeJob {
+  char action[32];
+  char device[48];
+  unsigned long queuedAt;
+  uint8_t worker; // İşi alan görev (görev başına ayrı HTTP istemcisi)
+};
+
+struct SmartHomeStats {
+  uint32_t queued;
+  uint32_t ok;
+  uint32_t failed;
+  uint32_t retries;
+  uint32_t dropped; // Kuyruk doluydu
+  int lastCode;
+  unsigned long lastLatencyMs; // Kuyruğa girişten sonuca kadar
+};
+SmartHomeStats smartHomeStats = {0, 0, 0, 0, 0, 0, 0};
+QueueHandle_t smartHomeQueue = NULL;
+
+// Komutu cihaza ileten yol. send() HTTP benzeri kod döner: 2xx başarılı,
+// 4xx kalıcı hata, <0 veya 5xx geçici hata (sıradaki taşıyıcı denenir).
+struct SmartHomeTransport {
+  const char *name;
+  bool (*available)();
+  int (*send)(const SmartHomeJob &job);
+  uint32_t sent;
+  uint32_t failed;
+  unsigned long lastUs; // Son gönderimin süresi
+  unsigned long maxUs;
+};
+
+void smartHomeInit();
+
+// ============================================
+//  CİHAZ KAYDI (NVS) & GEMINI İŞLEV ÇAĞRISI
+// ============================================
+// Cihazlar Gemini'ye set_device işlev bildirimi (enum) olarak gönderilir;
+// cevaptaki functionCall parçaları doğrudan eyleme çevrilir. Kayıt ilk
+// açılışta ve config.h'taki liste değişince SMART_HOME_DEVICES'tan
+// doldurulur, sonra NVS'ten okunur.
+#define DEVICE_MAX 16
+#define DEVICE_ACTION_COUNT 2
+
+// Bit i = DEVICE_ACTION_NAMES[i]
+const char *const DEVICE_ACTION_NAMES[DEVICE_ACTION_COUNT] = {"turn_on",
+                                                              "turn_off"};
+const char *const DEVICE_ACTION_VERBS[DEVICE_ACTION_COUNT] = {"açılıyor",
+                                                              "kapatılıyor"};
+
+struct SmartDevice {
+  char id[48];     // MQTT konusu / webhook olayı (SmartHomeJob.device)
+  char name[32];   // Konuşmadaki adı ("Salon ışığı")
+  uint8_t actions; // Desteklenen eylem bitleri
+};
+SmartDevice devices[DEVICE_MAX];
+int deviceCount = 0;
+// Kayıttan bir kez üretilir: systemInstruction + tools (dış parantezsiz)
+String geminiStatic = "";
+
+struct SmartHomeAction {
+  char cmd[32];
+  char device[48];
+};
+
+// Gemini cevabı: düz metin ve/veya doğrulanmış set_device çağrıları
+struct GeminiReply {
+  String text;
+  int actionCount;
+  SmartHomeAction actions[SMART_HOME_MAX_ACTIONS];
+};
+
+void deviceRegistryInit();
+const SmartDevice *deviceFind(const char *id);
+int deviceActionIndex(const char *action);
+String deviceConfirmation(const GeminiReply &reply);
+bool askGemini(const String &userText, GeminiReply &reply);
+
+// ============================================
+//  CİHAZ DURUM ÖNBELLEĞİ
+// ============================================
+// "Salon ışığı açık mı?" Gemini'ye gitmez: durum, gönderilen komutlardan ve
+// (isteğe bağlı) Home Assistant'ın MQTT durum konularından tutulur, cevap
+// yerelde kurulur. Cevap sesleri (cihaz x durum) ilk kullanımda sentezlenip
+// PSRAM'de saklanır.
+#define DEVICE_QUERY_CMD "query_state" // KWS şablonlarında soru eylemi
+#define PHRASE_CACHE_MAX_BYTES (512 * 1024)
+
+enum DeviceStateSource {
+  DEVICE_SOURCE_NONE,
+  DEVICE_SOURCE_COMMAND, // Bizim gönderdiğimiz komut (iyimser)
+  DEVICE_SOURCE_HA       // Home Assistant durum yayını
+};
+const char *const DEVICE_SOURCE_NAMES[] = {"yok", "komut", "Home Assistant"};
+
+struct DeviceState {
+  volatile int8_t on; // 1 açık, 0 kapalı, -1 bilinmiyor
+  volatile uint8_t source;
+  volatile unsigned long updatedAt;
+};
+DeviceState deviceStates[DEVICE_MAX];
+
+// Cevap sesi önbelleği: [cihaz][durum + 1], playbackEnqueue(owned=false)
+struct PhraseCache {
+  int16_t *pcm[DEVICE_MAX][3];
+  size_t samples[DEVICE_MAX][3];
+  size_t bytes;
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t answers; // Yerelde cevaplanan durum soruları
+};
+PhraseCache phraseCache;
+
+int deviceIndex(const char *id);
+void deviceStateSet(const char *id, int8_t on, uint8_t source);
+int deviceStatusQuery(const String &transcript);
+void deviceAnswerState(int index);
+
+// ============================================
+//  METRİKLER (bkz. metrics.h)
+// ============================================
+enum MetricStage {
+  METRIC_STT,
+  METRIC_LLM,
+  METRIC_TTS,
+  METRIC_WEBHOOK,
+  METRIC_STAGE_COUNT
+};
+const char *const METRIC_STAGE_NAMES[METRIC_STAGE_COUNT] = {"stt", "gemini",
+                                                            "tts", "webhook"};
+
+struct Metrics {
+  LatencyHistogram latency[METRIC_STAGE_COUNT];
+  HttpCodeCounter httpCodes[METRIC_STAGE_COUNT];
+  uint32_t wakeTriggers;
+  uint32_t followUps;
+  uint32_t wifiDisconnects;
+  uint32_t wifiConnects;
+  uint32_t mqttConnects;
+  // Son bir saatteki uyanmalar: dakika başına sayaç (tek yazar: ana döngü)
+  uint16_t wakePerMinute[60];
+  uint32_t wakeMinute[60];
+};
+Metrics metrics;
+
+void metricsInit();
+void metricsStage(MetricStage stage, unsigned long startMs, int httpCode);
+void metricsWake();
+
+// ============================================
+//  UYANMA MODELİ (bkz. wake_model.h)
+// ============================================
+WakeModel wakeModel = {NULL, 0, -1, {}, NULL, 0, 0};
+// Sunucu görevi yeni modeli yazdı; ana döngü IDLE'da yeniden eşler. Bayrak
+// inikken wakeModel'e sadece ana döngü, kalkıkken sadece okuma yapılır.
+volatile bool wakeModelReloadPending = false;
+
+void wakeModelInit();
+void wakeModelReload();
+void wakeWordInit();
+
+// ============================================
+//  DÜŞÜK GÜÇLÜ BEKLEME
+// ============================================
+#define PRE_ROLL_SAMPLES (SAMPLE_RATE * PRE_ROLL_MS / 1000)
+
+struct PowerIdle {
+  bool active;       // Düşük saatte, modem uykusunda
+  int32_t *preRoll;  // Ham I2S örnekleri (PSRAM halkası)
+  size_t preRollHead;
+  size_t preRollFill;
+  uint32_t blocks;   // Bu beklemede okunan blok
+  unsigned long enteredAt;
+  uint64_t idleMs;   // Tamamlanmış beklemeler
+  uint64_t busyCycles; // Bekleme bloklarında ana döngünün harcadığı
+  uint32_t wakes;
+  uint32_t wakeUsLast; // Tetik bloğundan tam hıza + ön kaydın eklenmesine
+  uint32_t wakeUsMax;
+  uint32_t clockUsLast; // Bunun saat + Wi-Fi geçişi kadarı
+};
+PowerIdle powerIdle = {false, NULL, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+void powerIdleInit();
+void powerIdleEnter();
+void powerIdleExit();
+void powerIdlePush(const int32_t *raw, int n);
+void powerIdleFlush(unsigned long triggerUs);
+
+// ============================================
+//  TUR SÜRE BÜTÇESİ
+// ============================================
+struct TurnBudget {
+  unsigned long start;
+  unsigned long deadline;
+  bool active; // Kayıt bitti, ilk ses henüz kuyruğa girmedi
+  uint32_t turns;
+  uint32_t expired;   // Bütçe bitti, özür okundu
+  uint32_t hedged;    // Gemini isteği ikinci bağlantıdan tekrarlandı
+  uint32_t hedgeWins; // İkinci istek önce döndü
+  unsigned long worstMs;
+};
+TurnBudget turn = {0, 0, false, 0, 0, 0, 0, 0};
+
+void turnBegin();
+void turnFirstAudio();
+uint32_t turnStageBudget(MetricStage stage);
+bool turnExpired();
+void turnApology();
+
+// Kapsam bitince bağlantı kilidini bırakır (erken return'ler için)
+struct NetLease {
+  NetHost host;
+  WiFiClientSecure *client; // NULL: kilit waitMs içinde alınamadı
+  NetLease(NetHost h, uint32_t waitMs)
+      : host(h), client(netAcquire(h, waitMs)) {}
+  ~NetLease() {
+    if (client)
+      netRelease(host);
+  }
+};
+
+// Mutlak bitiş anına kalan süre (geçtiyse 0)
+uint32_t netMsLeft(unsigned long deadline) {
+  long left = (long)(deadline - millis());
+  return left > 0 ? (uint32_t)left : 0;
+}
+
+// HTTPClient zaman aşımı okuma başınadır: yavaş damlayan cevap aşamayı
+// sınırsız uzatabilir. Bu sarmalayıcı gövdeyi mutlak bitiş anında ya da
+// iptal edilince keser; kesilen bağlantı yeniden kullanılmamalı (stop).
+class DeadlineStream : public Stream {
+public:
+  DeadlineStream(Stream &src, unsigned long at,
+                 const volatile bool *stop = NULL)
+      : in(src), deadline(at), cancel(stop), cut(false) {
+    setTimeout(0); // readBytes() kesildikten sonra ayrıca beklemesin
+  }
+
+  bool expired() const { return cut; }
+
+  int available() override { return over() ? 0 : in.available(); }
+
+  int peek() override { return waitData() ? in.peek() : -1; }
+
+  int read() override { return waitData() ? in.read() : -1; }
+
+  size_t write(uint8_t) override { return 0; }
+
+private:
+  Stream &in;
+  unsigned long deadline;
+  const volatile bool *cancel;
+  bool cut;
+
+  bool over() {
+    if (!cut && ((long)(deadline - millis()) <= 0 || (cancel && *cancel)))
+      cut = true;
+    return cut;
+  }
+
+  bool waitData() {
+    while (!over()) {
+      if (in.available())
+        return true;
+      delay(1); // Diğer görevlere (çalma, ağ) işlemci bırak
+    }
+    return false;
+  }
+};
 
 // ============================================
 //  BASE64
@@ -200,35 +950,47 @@ void setup() {
   delay(500);
   Serial.println("\n=== ESP32-S3 Sesli Asistan v3 ===");
 
-  strip.begin();
-  strip.setBrightness(50); // %20 parlaklık yeterli
-  strip.show();            // Söndür (siyah)
+  ledInit();
+  memTelemetryInit();
 
-  recordBuffer = (int16_t *)ps_malloc(MAX_RECORD_SAMPLES * sizeof(int16_t));
-  if (!recordBuffer) {
+#ifdef USE_SPECULATIVE_STT
+  sttSpecInit();
+#endif
+#ifdef USE_STREAMING_STT
+  sttStreamInit();
+#endif
+  if (!recordStoreInit()) {
     Serial.println("HATA: PSRAM bulunamadı! Tools > PSRAM > OPI PSRAM seç.");
     while (1)
       ;
   }
-  Serial.printf("PSRAM tampon hazır: %d KB\n",
-                (MAX_RECORD_SAMPLES * sizeof(int16_t)) / 1024);
+  Serial.printf("PSRAM kayıt deposu hazır: %d KB blok, en fazla %d sn\n",
+                RECORD_BLOCK_BYTES / 1024, RECORD_MAX_SECONDS);
 
+  afeInit(frontEnd);
+#ifdef USE_NOISE_SUPPRESSION
+  nsInit(noiseSuppressor);
+#endif
+#ifdef USE_LOCAL_COMMANDS
+  kwsStoreInit();
+#endif
   i2s_mic_init();
   i2s_speaker_init();
+  playbackInit();
   wifi_connect();
+  netWarmupInit();
+  smartHomeInit();
+#ifdef USE_METRICS
+  metricsInit();
+#endif
+#ifdef USE_LOW_POWER_IDLE
+  powerIdleInit();
+#endif
 
-#ifdef USE_WAKE_WORD
-  pv_status_t status = pv_porcupine_init(
-      PICOVOICE_ACCESS_KEY, sizeof(KEYWORD_MODEL), KEYWORD_MODEL,
-      0.5f, // Hassasiyet (0..1)
-      memory_buffer, MEMORY_BUFFER_SIZE, &porcupine);
-
-  if (status != PV_STATUS_SUCCESS) {
-    Serial.printf("[Porcupine] Init Hatası: %s\n", pv_status_to_string(status));
-  } else {
-    Serial.println("[Porcupine] 'Hey Alex' motoru hazır!");
-  }
+#ifdef USE_WAKE_MODEL_PARTITION
+  wakeModelInit();
 #endif
+  wakeWordInit();
 
   Serial.println("\n[Sistem] Hazır! Konuşmak için ses çıkar.");
   setState(STATE_IDLE);
@@ -238,25 +1000,73 @@ void setup() {
 //  ANA DÖNGÜ
 // ============================================
 void loop() {
-  handleLedEffects(); // LED animasyonlarını güncelle
-
   size_t bytesRead = 0;
   i2s_read(MIC_PORT, &rawBuffer, sizeof(rawBuffer), &bytesRead, portMAX_DELAY);
   if (bytesRead == 0)
     return;
+  unsigned long blockUs = micros();
+  uint32_t blockCycles = ESP.getCycleCount();
+
+  // Düşük güçlü beklemede enerji seyreltilmiş örneklerden ölçülür ve ön
+  // işleme her IDLE_FULL_BLOCK_EVERY blokta bir çalışır
+  bool fullBlock = true;
+  int step = 1;
+#ifdef USE_LOW_POWER_IDLE
+  if (powerIdle.active) {
+    powerIdlePush(rawBuffer, bytesRead / sizeof(int32_t));
+    fullBlock = powerIdle.blocks++ % IDLE_FULL_BLOCK_EVERY == 0;
+    step = IDLE_RMS_DECIMATION;
+  }
+#endif
+  float rms = MicAudio::rms(rawBuffer, bytesRead / sizeof(int32_t), step);
+
+  // Ön işleme IDLE'da da çalışır: LISTENING başladığında filtreler oturmuş,
+  // AGC kazancı tetikleyen sese göre ayarlanmış olur.
+  if (fullBlock) {
+#ifdef USE_LOW_POWER_IDLE
+    // Aradaki bloklar işlenmedi: filtre ve çerçeve durumu blok öncesinden.
+    // Eklenirse DC/HPF salınır ve NS uzak blokları birleştirip öğrenir.
+    if (powerIdle.active && IDLE_FULL_BLOCK_EVERY > 1) {
+      afeResetFilters(frontEnd, rawBuffer[0]);
+#ifdef USE_NOISE_SUPPRESSION
+      nsResetStream(noiseSuppressor);
+#endif
+    }
+#endif
+    uint32_t c0 = ESP.getCycleCount();
+    afeProcess(frontEnd, rawBuffer, frontEndBuffer,
+               bytesRead / sizeof(int32_t));
+    frontEnd.cycles += ESP.getCycleCount() - c0;
+    frontEnd.blocks++;
 
-  float rms = calculateRMS(bytesRead / sizeof(int32_t));
+#ifdef USE_NOISE_SUPPRESSION
+    // Gürültü sadece IDLE'da ve eşiğin altındayken (konuşma yokken) öğrenilir;
+    // profil AGC kazancından bağımsız tutulur
+    c0 = ESP.getCycleCount();
+    nsProcess(noiseSuppressor, frontEndBuffer, frontEndBuffer,
+              bytesRead / sizeof(int32_t),
+              currentState == STATE_IDLE && rms < WAKE_THRESHOLD / 2,
+              afeGain(frontEnd));
+    noiseSuppressor.cycles += ESP.getCycleCount() - c0;
+    noiseSuppressor.blocks++;
+#endif
+  }
 
   switch (currentState) {
 
   case STATE_IDLE:
+#ifdef USE_WAKE_MODEL_PARTITION
+    if (wakeModelReloadPending)
+      wakeModelReload();
+#endif
 #ifdef USE_WAKE_WORD
     // Wake Word (Uyandırma Kelimesi) Kontrolü
     // Bu kısım ESP-SR kütüphanesi gerektirir.
     // Şimdilik simülasyon veya placeholder kodu:
     if (detectWakeWord(rawBuffer, bytesRead)) {
       Serial.println("[WakeWord] 'Hi ESP' algılandı!");
-      recordIndex = 0;
+      recordClear();
+      metricsWake();
       setState(STATE_LISTENING);
     }
 #else
@@ -267,30 +1077,86 @@ void loop() {
         wakeStartTime = millis();
       }
       if (millis() - wakeStartTime > WAKE_CONFIRM_MS) {
-        recordIndex = 0;
+        recordClear();
+        metricsWake();
+#ifdef USE_LOW_POWER_IDLE
+        powerIdleFlush(blockUs); // Tam hız + tetikten önceki ses
+#endif
+        wakeChimeSkip = true;
         setState(STATE_LISTENING);
+        break;
       }
     } else {
       soundDetected = false;
     }
+#endif
+#ifdef USE_LOW_POWER_IDLE
+    if (powerIdle.active)
+      powerIdle.busyCycles += ESP.getCycleCount() - blockCycles;
 #endif
     break;
 
   case STATE_LISTENING: {
-    if (rms > WAKE_THRESHOLD / 2)
-      lastSoundTime = millis();
-
     int samplesRead = bytesRead / sizeof(int32_t);
-    for (int i = 0; i < samplesRead && recordIndex < MAX_RECORD_SAMPLES; i++) {
-      recordBuffer[recordIndex++] = (int16_t)(rawBuffer[i] >> 16);
+
+    // Takip penceresi: konuşma başlayana kadar kayıt yok, sessizlik sayılmaz
+    if (followUpActive && !followUpHeard) {
+      if ((long)(millis() - followUpIgnoreUntil) < 0)
+        break; // Kendi sesimizin kuyruğu, tetikleme yok
+      if (rms <= WAKE_THRESHOLD) {
+        if (soundDetected) { // Onaylanmayan kısa ses (tık, kapı): at
+          soundDetected = false;
+          recordClear();
+        }
+        if ((long)(millis() - followUpDeadline) > 0) {
+          Serial.println("[Takip] Konuşma yok, IDLE'a dönülüyor.");
+          followUpActive = false;
+          setState(STATE_IDLE);
+        }
+        break;
+      }
+      // IDLE ile aynı onay süresi; bu sürede ses kayda alınır (tetikleyen
+      // hece kaybolmaz) ama akışlı tanıma henüz başlatılmaz
+      if (!soundDetected) {
+        soundDetected = true;
+        wakeStartTime = millis();
+      }
+      recordAppend(frontEndBuffer, samplesRead);
+      if (millis() - wakeStartTime <= WAKE_CONFIRM_MS)
+        break;
+      followUpHeard = true;
+      followUpTurns++;
+      metricInc(metrics.followUps);
+      Serial.printf("[Takip] Konuşma algılandı (%u. takip)\n", followUpTurns);
+      lastSoundTime = millis();
+#ifdef USE_STREAMING_STT
+      sttStreamBegin(); // Onay süresindeki ses de gönderilir
+#endif
+      break; // Bu blok zaten kayıtta
     }
 
+    if (rms > WAKE_THRESHOLD / 2)
+      lastSoundTime = millis();
+
+#ifdef USE_STREAMING_STT
+    if (recordSampleCount() == 0)
+      sttStreamBegin(); // Kayıt başlıyor (uyanma ya da takip sorusu)
+#endif
+    bool bufferFull = !recordAppend(frontEndBuffer, samplesRead);
     bool silenceEnd = (millis() - lastSoundTime > SILENCE_TIMEOUT_MS);
-    bool bufferFull = (recordIndex >= MAX_RECORD_SAMPLES);
+    bool serverEnd = false;
+#ifdef USE_STREAMING_STT
+    serverEnd = sttStreamHealthy() && sttStream.endOfUtterance;
+#endif
+#ifdef USE_SPECULATIVE_STT
+    if (!silenceEnd && !bufferFull && !serverEnd && !sttStreamHealthy())
+      sttSpecPoll();
+#endif
 
-    if (silenceEnd || bufferFull) {
+    if (silenceEnd || bufferFull || serverEnd) {
       Serial.printf("[Kayıt] Bitti: %.1f sn\n",
-                    (float)recordIndex / SAMPLE_RATE);
+                    (float)recordSampleCount() / SAMPLE_RATE);
+      followUpActive = false;
       setState(STATE_THINKING);
       processVoiceCommand();
     }
@@ -307,31 +1173,91 @@ void loop() {
 //  ANA İŞLEM FONKSİYONU
 // ============================================
 void processVoiceCommand() {
+  turnBegin();
+#ifdef USE_LOCAL_COMMANDS
+  // Önce cihazda dene: bilinen bir komutsa buluta hiç gitme
+  const KwsTemplate *local = kwsRecognize();
+  if (local) {
+    Serial.printf("[KWS] Yerel komut: %s -> %s (isabet %u/%u)\n", local->cmd,
+                  local->device, kwsStats.hits, kwsStats.attempts);
+    int queried = strcmp(local->cmd, DEVICE_QUERY_CMD) == 0
+                      ? deviceIndex(local->device)
+                      : -1;
+    if (queried >= 0) {
+      deviceAnswerState(queried); // STT de yok, sadece önbellek
+      finishTurn();
+      return;
+    }
+    executeSmartHomeCommand(local->cmd, local->device);
+    setState(STATE_SPEAKING);
+    textToSpeech(local->speech[0] ? String(local->speech) : String("Tamam."),
+                 true);
+    finishTurn();
+    return;
+  }
+#endif
+
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("[WiFi] Bağlantı yok, yeniden deneniyor...");
     wifi_connect();
     if (WiFi.status() != WL_CONNECTED) {
       Serial.println("[WiFi] Bağlanamadı, IDLE'a dönülüyor.");
+      setState(STATE_SPEAKING);
+      textToSpeech("İnternet bağlantısı yok.");
+      playbackFlush();
       setState(STATE_IDLE);
       return;
     }
   }
 
-  String transcript = speechToText();
+  String transcript;
+  bool haveTranscript = false;
+#ifdef USE_STREAMING_STT
+  haveTranscript = sttStreamTake(transcript);
+#endif
+#ifdef USE_SPECULATIVE_STT
+  if (!haveTranscript)
+    haveTranscript = sttSpecTake(transcript);
+  else
+    sttSpecDrop(); // Akış cevap verdi, spekülatif istek gereksiz
+#endif
+  if (!haveTranscript)
+    transcript = speechToText();
   if (transcript.isEmpty()) {
     Serial.println("[STT] Anlaşılamadı.");
+    if (turnExpired()) {
+      setState(STATE_SPEAKING);
+      turnApology();
+      playbackFlush();
+    }
     setState(STATE_IDLE);
     return;
   }
   Serial.println("Sen     : " + transcript);
 
-  String aiResponse = askGemini(transcript);
-  if (aiResponse.isEmpty()) {
+  // Durum sorusu: cevap önbellekte, LLM'e gitmeye gerek yok
+  int queried = deviceStatusQuery(transcript);
+  if (queried >= 0) {
+    deviceAnswerState(queried);
+    finishTurn();
+    return;
+  }
+
+  GeminiReply reply;
+  if (!askGemini(transcript, reply)) {
     Serial.println("[Gemini] Cevap alınamadı.");
+    if (turnExpired()) {
+      setState(STATE_SPEAKING);
+      turnApology();
+      playbackFlush();
+    }
     setState(STATE_IDLE);
     return;
   }
-  Serial.println("Asistan Ham Cevap: " + aiResponse);
+  String aiResponse = reply.text;
+  aiResponse.trim();
+  Serial.printf("Asistan Ham Cevap: %d işlev çağrısı, metin: %s\n",
+                reply.actionCount, aiResponse.c_str());
 
   // --- GEÇMİŞİ GÜNCELLE ---
   // Kaydırma (Shift) yap: dizi doluysa en eskiyi sil
@@ -347,38 +1273,32 @@ void processVoiceCommand() {
     chatHistory[historyCount].text = transcript;
     historyCount++;
   }
-  // Model ekle (JSON değilse)
+  // Model ekle (cihaz komutu değilse)
 
-  // JSON kontrolü (Basitçe '{' ile başlıyorsa JSON kabul ediyoruz)
-  aiResponse.trim();
-  if (aiResponse.startsWith("{") && aiResponse.endsWith("}")) {
-    // ... Smart Home kodu aynen kalıyor ...
-    // Smart home komutlarını geçmişe eklemek istemeyebiliriz veya
-    // ekleyebiliriz. Şimdilik eklemiyoruz, çünkü bağlamı bozabilir.
+  if (reply.actionCount > 0) {
+    // Cihaz komutları geçmişe eklenmez, bağlamı bozabilir
     Serial.println("[Gemini] Akıllı Ev Komutu Algılandı!");
 
-    DynamicJsonDocument cmdDoc(1024);
-    DeserializationError error = deserializeJson(cmdDoc, aiResponse);
-
-    if (!error) {
-      String cmd = cmdDoc["cmd"].as<String>();
-      String device = cmdDoc["device"].as<String>();
-      String speech = cmdDoc["speech"].as<String>();
+    // Her eylem hemen kuyruğa atılır; işçiler paralel gönderir
+    for (int i = 0; i < reply.actionCount; i++)
+      executeSmartHomeCommand(reply.actions[i].cmd, reply.actions[i].device);
+    Serial.printf("[SmartHome] %d eylem kuyruğa alındı.\n", reply.actionCount);
 
-      if (speech.isEmpty())
-        speech = "Tamam, hallediyorum.";
+    // Gemini işlev çağrısıyla metin döndürmediyse onay yerelde kurulur
+    String speech =
+        aiResponse.isEmpty() ? deviceConfirmation(reply) : aiResponse;
 
-      // Webhook tetikle
-      executeSmartHomeCommand(cmd, device);
+#ifdef USE_LOCAL_COMMANDS
+    // Tek eylemli komutun sesi bir dahaki sefere yerelde tanınsın
+    if (reply.actionCount == 1)
+      kwsEnroll(reply.actions[0].cmd, reply.actions[0].device, speech);
+#endif
 
-      // Onay konuşması yap
-      setState(STATE_SPEAKING);
-      textToSpeech(speech);
-      setState(STATE_IDLE);
-      return;
-    } else {
-      Serial.println("[Gemini] JSON Parse Hatası! Normal konuşma yapılıyor.");
-    }
+    // Tek ortak onay konuşması, webhook'larla paralel yapılır
+    setState(STATE_SPEAKING);
+    textToSpeech(speech, true); // Kısa onay: yerelde, bulutu bekleme
+    finishTurn();
+    return;
   }
 
   // Normal cevabı geçmişe ekle
@@ -392,58 +1312,539 @@ void processVoiceCommand() {
   Serial.println("Asistan : " + aiResponse);
   setState(STATE_SPEAKING);
   textToSpeech(aiResponse);
+  finishTurn();
+}
+
+// Cevap çalındıktan sonra: takip modu açıksa doğrudan dinlemeye geç
+void finishTurn() {
+  // Cevap motor kuyruğunda çalıyor; bitmesini bekle (LED/ağ görevleri sürer)
+  playbackFlush();
+
+  // Mikrofon DMA'sında THINKING/SPEAKING sırasında biriken (kendi sesimizi
+  // de içeren) eski veriyi at, yoksa hemen yeniden tetiklenir
+  size_t n = 0;
+  while (i2s_read(MIC_PORT, rawBuffer, sizeof(rawBuffer), &n, 0) == ESP_OK &&
+         n > 0)
+    ;
+
+#ifdef USE_FOLLOW_UP
+  recordClear();
+  followUpActive = true;
+  followUpHeard = false;
+  // Hoparlör DMA'sı playbackFlush'ta boşaldı; sadece yankı payı
+  followUpIgnoreUntil = millis() + PLAYBACK_TAIL_MS;
+  followUpDeadline = followUpIgnoreUntil + FOLLOW_UP_WINDOW_MS;
+  setState(STATE_LISTENING); // Soketler de yeniden ısıtılır
+#else
   setState(STATE_IDLE);
+#endif
 }
 
 // ============================================
-//  SPEECH TO TEXT — PSRAM tabanlı
+//  PARÇALI KAYIT DEPOSU
 // ============================================
-String speechToText() {
-  Serial.println("[STT] Gönderiliyor...");
+// G.711 μ-law kodlayıcı (14-bit doğrusal -> 8 bit)
+uint8_t mulawEncode(int16_t pcm) {
+  const int BIAS = 0x84, CLIP = 32635;
+  int sign = (pcm >> 8) & 0x80;
+  int v = sign ? -(int)pcm : pcm;
+  if (v > CLIP)
+    v = CLIP;
+  v += BIAS;
+  int exponent = 7;
+  for (int mask = 0x4000; (v & mask) == 0 && exponent > 0; mask >>= 1)
+    exponent--;
+  int mantissa = (v >> (exponent + 3)) & 0x0F;
+  return (uint8_t)~(sign | (exponent << 4) | mantissa);
+}
 
-  size_t audioBytes = recordIndex * sizeof(int16_t);
-  size_t b64Len = ((audioBytes + 2) / 3) * 4 + 1;
+int16_t mulawDecode(uint8_t u) {
+  u = ~u;
+  int exponent = (u >> 4) & 0x07;
+  int v = ((((u & 0x0F) << 3) + 0x84) << exponent) - 0x84;
+  return (int16_t)((u & 0x80) ? -v : v);
+}
 
-  char *b64Buf = (char *)ps_malloc(b64Len);
-  if (!b64Buf) {
-    Serial.println("[STT] HATA: PSRAM base64 yetersiz!");
-    return "";
+RecordBlock *recordTakeBlock() {
+  RecordBlock *b = recordStore.freeList;
+  if (b) {
+    recordStore.freeList = b->next;
+  } else {
+    b = (RecordBlock *)memTrackAlloc(sizeof(RecordBlock), true, "kayıt");
+    if (!b)
+      return NULL;
+    recordStore.blocksAllocated++;
   }
-  base64EncodeToBuf((const uint8_t *)recordBuffer, audioBytes, b64Buf);
+  b->next = NULL;
+  b->used = 0;
+  recordStore.blocksInUse++;
+  return b;
+}
 
-  size_t bodyLen = b64Len + 256;
-  char *bodyBuf = (char *)ps_malloc(bodyLen);
-  if (!bodyBuf) {
-    Serial.println("[STT] HATA: PSRAM body yetersiz!");
-    free(b64Buf);
+bool recordStoreInit() {
+  for (int i = 0; i < RECORD_PREALLOC_BLOCKS; i++) {
+    RecordBlock *b =
+        (RecordBlock *)memTrackAlloc(sizeof(RecordBlock), true, "kayıt");
+    if (!b)
+      return false;
+    b->next = recordStore.freeList;
+    recordStore.freeList = b;
+    recordStore.blocksAllocated++;
+  }
+  return true;
+}
+
+// Zinciri serbest listeye geri verir (free() yok, sonraki kayıtta kullanılır)
+void recordClear() {
+#ifdef USE_SPECULATIVE_STT
+  sttSpecDiscard(); // Arka planda bu blokları okuyan istek bitmeli
+#endif
+#ifdef USE_STREAMING_STT
+  sttStreamDiscard();
+#endif
+  if (recordStore.tail) {
+    recordStore.tail->next = recordStore.freeList;
+    recordStore.freeList = recordStore.head;
+  }
+  recordStore.head = recordStore.tail = NULL;
+  recordStore.samples = 0;
+  recordStore.blocksInUse = 0;
+}
+
+// false: süre sınırı doldu veya PSRAM bitti (kayıt sonlandırılmalı)
+bool recordAppend(const int16_t *pcm, int n) {
+#ifdef RECORD_MULAW
+  const size_t bytesPerSample = 1;
+#else
+  const size_t bytesPerSample = sizeof(int16_t);
+#endif
+  for (int i = 0; i < n; i++) {
+    if (recordStore.samples >= MAX_RECORD_SAMPLES)
+      return false;
+    RecordBlock *t = recordStore.tail;
+    if (!t || t->used + bytesPerSample > RECORD_BLOCK_BYTES) {
+      RecordBlock *b = recordTakeBlock();
+      if (!b) {
+        Serial.println("[Kayıt] HATA: PSRAM yetersiz, kayıt kesildi!");
+        return false;
+      }
+      if (t)
+        t->next = b;
+      else
+        recordStore.head = b;
+      recordStore.tail = t = b;
+    }
+#ifdef RECORD_MULAW
+    t->data[t->used++] = mulawEncode(pcm[i]);
+#else
+    memcpy(t->data + t->used, &pcm[i], sizeof(int16_t));
+    t->used += sizeof(int16_t);
+#endif
+    recordStore.samples++;
+  }
+  return recordStore.samples < MAX_RECORD_SAMPLES;
+}
+
+size_t recordByteCount() {
+  size_t total = 0;
+  for (RecordBlock *b = recordStore.head; b; b = b->next)
+    total += b->used;
+  return total;
+}
+
+float recordBytesToSeconds(size_t bytes) {
+#ifdef RECORD_MULAW
+  return (float)bytes / SAMPLE_RATE;
+#else
+  return (float)bytes / (SAMPLE_RATE * sizeof(int16_t));
+#endif
+}
+
+// STT istek gövdesi: önek + base64(kayıt blokları) + sonek, bayt bayt üretilir.
+// HTTPClient::sendRequest(Stream*) ile Content-Length bilinerek gönderilir.
+class SttBodyStream : public Stream {
+public:
+  // audioLimit: kayıt büyümeye devam ederken sadece ilk bu kadar bayt
+  explicit SttBodyStream(size_t audioLimit = SIZE_MAX) {
+#ifdef RECORD_MULAW
+    const char *encoding = "MULAW";
+#else
+    const char *encoding = "LINEAR16";
+#endif
+    prefix = String("{\"config\":{\"encoding\":\"") + encoding +
+             "\",\"sampleRateHertz\":" + String(SAMPLE_RATE) +
+             ",\"languageCode\":\"tr-TR\"},\"audio\":{\"content\":\"";
+    suffix = "\"}}";
+    audioBytes = recordByteCount();
+    if (audioBytes > audioLimit)
+      audioBytes = audioLimit;
+    total = prefix.length() + ((audioBytes + 2) / 3) * 4 + suffix.length();
+    block = recordStore.head;
+    blockPos = 0;
+    pos = 0;
+    quadLen = quadPos = 0;
+  }
+
+  size_t size() const { return total; }
+
+  // Bitiş anında (ya da iptalde) gönderim yarıda kesilir: HTTPClient
+  // available() < 0 görünce yüklemeyi bırakır
+  void setDeadline(unsigned long at, const volatile bool *stop = NULL) {
+    deadline = at;
+    cancel = stop;
+    hasDeadline = true;
+  }
+
+  bool expired() const { return cut; }
+
+  int available() override {
+    if (hasDeadline && !cut &&
+        ((long)(deadline - millis()) <= 0 || (cancel && *cancel)))
+      cut = true;
+    if (cut)
+      return -1;
+    size_t left = total - pos;
+    return left > 0x7FFFFFFF ? 0x7FFFFFFF : (int)left;
+  }
+
+  int peek() override {
+    if (pos >= total)
+      return -1;
+    size_t p = prefix.length();
+    if (pos < p)
+      return prefix[pos];
+    if (quadPos >= quadLen && !fillQuad())
+      return suffix[pos - p - encodedBytes()];
+    return quad[quadPos];
+  }
+
+  int read() override {
+    int c = peek();
+    if (c < 0)
+      return -1;
+    if (pos >= prefix.length() && quadPos < quadLen)
+      quadPos++;
+    pos++;
+    return c;
+  }
+
+  size_t write(uint8_t) override { return 0; }
+
+private:
+  String prefix, suffix;
+  size_t audioBytes, total, pos;
+  RecordBlock *block;
+  size_t blockPos;
+  size_t consumed = 0; // Okunan ses baytı
+  unsigned long deadline = 0;
+  const volatile bool *cancel = NULL;
+  bool hasDeadline = false;
+  bool cut = false;
+  char quad[4];
+  int quadLen, quadPos;
+
+  size_t encodedBytes() const { return ((audioBytes + 2) / 3) * 4; }
+
+  int nextByte() {
+    while (block && blockPos >= block->used) {
+      block = block->next;
+      blockPos = 0;
+    }
+    if (!block)
+      return -1;
+    consumed++;
+    return block->data[blockPos++];
+  }
+
+  // Sıradaki 3 ses baytını 4 base64 karakterine çevirir
+  bool fillQuad() {
+    if (consumed >= audioBytes)
+      return false;
+    uint8_t in[3] = {0, 0, 0};
+    int n = 0;
+    for (; n < 3; n++) {
+      int c = nextByte();
+      if (c < 0)
+        break;
+      in[n] = (uint8_t)c;
+    }
+    if (n == 0)
+      return false;
+    quad[0] = b64chars[in[0] >> 2];
+    quad[1] = b64chars[((in[0] & 3) << 4) | (in[1] >> 4)];
+    quad[2] = (n > 1) ? b64chars[((in[1] & 15) << 2) | (in[2] >> 6)] : '=';
+    quad[3] = (n > 2) ? b64chars[in[2] & 63] : '=';
+    quadLen = 4;
+    quadPos = 0;
+    return true;
+  }
+};
+
+#ifdef USE_LOCAL_COMMANDS
+// ============================================
+//  YEREL KOMUT TANIMA
+// ============================================
+size_t kwsTemplateBytes(const KwsTemplate &t) {
+  return offsetof(KwsTemplate, data) + t.frames * sizeof(KwsVector);
+}
+
+// false: NVS dolu; yarım yazılmış anahtar silinir
+bool kwsSaveTemplate(int index) {
+  char key[8];
+  snprintf(key, sizeof(key), "t%d", index);
+  size_t bytes = kwsTemplateBytes(kwsTemplates[index]);
+  if (preferences.putBytes(key, &kwsTemplates[index], bytes) == bytes)
+    return true;
+  preferences.remove(key);
+  return false;
+}
+
+size_t kwsStoredBytes() {
+  size_t total = 0;
+  for (int i = 0; i < kwsTemplateCount; i++)
+    total += kwsTemplateBytes(kwsTemplates[i]);
+  return total;
+}
+
+bool kwsStoreInit() {
+  kwsInit(kwsTables);
+  kws = (KwsWorkspace *)memTrackAlloc(sizeof(KwsWorkspace), true, "kws");
+  kwsTemplates = (KwsTemplate *)memTrackAlloc(
+      sizeof(KwsTemplate) * KWS_MAX_TEMPLATES, true, "kws şablon");
+  if (!kws || !kwsTemplates) {
+    Serial.println("[KWS] HATA: PSRAM yetersiz, yerel komutlar kapalı.");
+    free(kws);
+    free(kwsTemplates);
+    kws = NULL;
+    kwsTemplates = NULL;
+    return false;
+  }
+  kws->utteranceValid = false;
+
+  preferences.begin("alex-kws", false);
+  int stored = preferences.getInt("count", 0);
+  kwsTemplateCount = 0;
+  for (int i = 0; i < stored && i < KWS_MAX_TEMPLATES; i++) {
+    char key[8];
+    snprintf(key, sizeof(key), "t%d", i);
+    KwsTemplate &t = kwsTemplates[kwsTemplateCount];
+    size_t len = preferences.getBytes(key, &t, sizeof(KwsTemplate));
+    if (len < offsetof(KwsTemplate, data) || t.frames == 0 ||
+        t.frames > KWS_TEMPLATE_MAX_FRAMES || len != kwsTemplateBytes(t))
+      continue; // Bozuk / eski sürüm kayıt
+    t.cmd[sizeof(t.cmd) - 1] = '\0';
+    t.device[sizeof(t.device) - 1] = '\0';
+    t.speech[sizeof(t.speech) - 1] = '\0';
+    kwsTemplateCount++;
+  }
+  if (kwsTemplateCount != stored) {
+    // Atlanan kayıt varsa indeksler kaydı; sıkıştırıp yeniden yaz
+    int saved = 0;
+    while (saved < kwsTemplateCount && kwsSaveTemplate(saved))
+      saved++;
+    kwsTemplateCount = saved;
+    preferences.putInt("count", kwsTemplateCount);
+  }
+  preferences.end();
+
+  Serial.printf("[KWS] %d komut şablonu yüklendi (%d KB PSRAM).\n",
+                kwsTemplateCount,
+                (int)((sizeof(KwsWorkspace) +
+                       sizeof(KwsTemplate) * KWS_MAX_TEMPLATES) /
+                      1024));
+  return true;
+}
+
+// Kayıt deposunu (μ-law ya da 16-bit bloklar) çözüp MFCC çıkarır
+bool kwsExtractRecording() {
+  kwsBegin(kws->ex, kws->utterance);
+  kws->utteranceValid = false;
+  // Sessizlik payı dahil KWS_MAX_FRAMES'i aşan kayıt komut değildir
+  if (recordSampleCount() > (size_t)KWS_MAX_FRAMES * KWS_HOP)
+    return false;
+
+  for (RecordBlock *b = recordStore.head; b; b = b->next) {
+#ifdef RECORD_MULAW
+    for (size_t i = 0; i < b->used; i += 256) {
+      int n = (b->used - i < 256) ? (int)(b->used - i) : 256;
+      for (int k = 0; k < n; k++)
+        kws->pcm[k] = mulawDecode(b->data[i + k]);
+      if (!kwsFeed(kwsTables, kws->ex, kws->utterance, kws->pcm, n))
+        return false;
+    }
+#else
+    if (!kwsFeed(kwsTables, kws->ex, kws->utterance, (const int16_t *)b->data,
+                 b->used / sizeof(int16_t)))
+      return false;
+#endif
+  }
+  int frames = kwsFinish(kws->utterance);
+  kws->utteranceValid =
+      frames >= KWS_MIN_SPEECH_FRAMES && frames <= KWS_TEMPLATE_MAX_FRAMES;
+  return kws->utteranceValid;
+}
+
+bool kwsSameCommand(const KwsTemplate &a, const KwsTemplate &b) {
+  return strcmp(a.cmd, b.cmd) == 0 && strcmp(a.device, b.device) == 0;
+}
+
+// Eşleşen şablonu ya da NULL döner. Özellikler öğrenme için saklanır.
+const KwsTemplate *kwsRecognize() {
+  if (!kws)
+    return NULL;
+  kwsStats.attempts++;
+
+  uint32_t start = micros();
+  bool valid = kwsExtractRecording();
+  kwsStats.lastFeatureUs = micros() - start;
+  float audioMs = recordSampleCount() * 1000.0f / SAMPLE_RATE;
+  Serial.printf("[KWS] MFCC: %lu ms (%d çerçeve, %.0f ms ses, gerçek "
+                "zamanın %%%.1f'i)\n",
+                (unsigned long)(kwsStats.lastFeatureUs / 1000),
+                kws->utterance.count, audioMs,
+                audioMs > 0 ? kwsStats.lastFeatureUs / (audioMs * 10.0f) : 0);
+  if (!valid || kwsTemplateCount == 0)
+    return NULL;
+
+  // Şablonun sınıfı: aynı komut/cihaz çiftinin ilk şablonunun indeksi
+  KwsRef refs[KWS_MAX_TEMPLATES];
+  for (int i = 0; i < kwsTemplateCount; i++) {
+    int j = 0;
+    while (j < i && !kwsSameCommand(kwsTemplates[i], kwsTemplates[j]))
+      j++;
+    refs[i] = {kwsTemplates[i].data, kwsTemplates[i].frames, j};
+  }
+  const KwsThresholds th = {KWS_ACCEPT_DIST, KWS_MARGIN_PCT, KWS_FILLER_PCT,
+                            KWS_MIN_COMMANDS};
+  int32_t dist[KWS_MAX_TEMPLATES];
+  start = micros();
+  KwsDecision d = kwsDecide(kws->utterance, refs, kwsTemplateCount, th, dist,
+                            kws->dtwRow);
+  kwsStats.lastDtwUs = micros() - start;
+  if (d.best < 0)
+    return NULL; // Rakip komut yok
+
+  const KwsTemplate &best = kwsTemplates[d.best];
+  Serial.printf("[KWS] DTW: %lu ms (%d şablon) | En yakın: %s/%s = %ld, "
+                "rakip = %ld, çöp = %ld -> %s\n",
+                (unsigned long)(kwsStats.lastDtwUs / 1000), kwsTemplateCount,
+                best.cmd, best.device, (long)d.dist, (long)d.rival,
+                (long)d.filler, d.accept ? "KABUL" : "bulut");
+  if (!d.accept)
+    return NULL;
+  kwsStats.hits++;
+  kws->utteranceValid = false; // Yerel eşleşme tekrar öğrenilmez
+  return &best;
+}
+
+// Bulutun anladığı tek eylemli komutu, son kaydın özellikleriyle şablon yapar
+void kwsEnroll(const String &cmd, const String &device, const String &speech) {
+  if (!kws || !kws->utteranceValid)
+    return;
+  kws->utteranceValid = false; // Aynı kayıt iki kez öğrenilmesin
+
+  if (kwsTemplateCount >= KWS_MAX_TEMPLATES) {
+    Serial.println("[KWS] Şablon alanı dolu, yeni komut öğrenilmedi.");
+    return;
+  }
+  KwsTemplate &t = kwsTemplates[kwsTemplateCount];
+  cmd.toCharArray(t.cmd, sizeof(t.cmd));
+  device.toCharArray(t.device, sizeof(t.device));
+  int same = 0;
+  for (int i = 0; i < kwsTemplateCount; i++)
+    if (kwsSameCommand(kwsTemplates[i], t))
+      same++;
+  if (same >= KWS_TEMPLATES_PER_COMMAND)
+    return;
+
+  // Yarım kalan UTF-8 karakter okunmasın diye sığmayan cümle saklanmaz
+  if (speech.length() < sizeof(t.speech))
+    speech.toCharArray(t.speech, sizeof(t.speech));
+  else
+    t.speech[0] = '\0';
+  t.frames = (uint16_t)kws->utterance.count;
+  memcpy(t.data, kws->utterance.frames, t.frames * sizeof(KwsVector));
+
+  if (kwsStoredBytes() + kwsTemplateBytes(t) > KWS_NVS_MAX_BYTES) {
+    Serial.println("[KWS] NVS şablon payı dolu, yeni komut öğrenilmedi.");
+    return;
+  }
+  preferences.begin("alex-kws", false);
+  bool saved = kwsSaveTemplate(kwsTemplateCount) &&
+               preferences.putInt("count", kwsTemplateCount + 1) != 0;
+  if (!saved) {
+    char key[8];
+    snprintf(key, sizeof(key), "t%d", kwsTemplateCount);
+    preferences.remove(key); // Sayaç artmadı, şablon yarım kalmasın
+  }
+  preferences.end();
+  if (!saved) {
+    Serial.println("[KWS] HATA: NVS'e yazılamadı, şablon öğrenilmedi.");
+    return;
+  }
+  kwsTemplateCount++;
+  kwsStats.enrolled++;
+  Serial.printf("[KWS] Öğrenildi: %s/%s (%d çerçeve, örnek %d/%d)\n", t.cmd,
+                t.device, t.frames, same + 1, KWS_TEMPLATES_PER_COMMAND);
+}
+#endif
+
+// ============================================
+//  SPEECH TO TEXT — PSRAM tabanlı
+// ============================================
+String speechToText() {
+  uint32_t budget = turnStageBudget(METRIC_STT);
+  if (budget < TURN_MIN_STAGE_MS) {
+    Serial.println("[STT] Tur süresi doldu, gönderilmedi.");
     return "";
   }
+  return sttRequest(recordByteCount(), budget);
+}
 
-  snprintf(bodyBuf, bodyLen,
-           "{\"config\":{"
-           "\"encoding\":\"LINEAR16\","
-           "\"sampleRateHertz\":%d,"
-           "\"languageCode\":\"tr-TR\""
-           "},\"audio\":{\"content\":\"%s\"}}",
-           SAMPLE_RATE, b64Buf);
-  free(b64Buf);
+// Kaydın ilk audioBytes baytını paylaşılan (ısıtılmış) bağlantıdan tanır
+String sttRequest(size_t audioBytes, uint32_t timeoutMs) {
+  unsigned long deadline = millis() + timeoutMs; // Kilit + gönderim + cevap
+  NetLease lease(NET_HOST_STT, timeoutMs);
+  if (!lease.client)
+    return "";
+  return sttPost(*lease.client, audioBytes, deadline, NULL);
+}
+
+// Tek istek; spekülatif görev kendi istemcisiyle çağırır. cancel: sonuç
+// artık gerekmiyorsa yükleme ve cevap okuma kesilir.
+String sttPost(WiFiClientSecure &client, size_t audioBytes,
+               unsigned long deadline, const volatile bool *cancel) {
+  Serial.println("[STT] Gönderiliyor...");
 
-  WiFiClientSecure client;
-  client.setInsecure();
+  // Gövde kayıt bloklarından akış halinde üretilir; tek parça tampon yok
+  SttBodyStream body(audioBytes);
+  Serial.printf("[STT] %.1f sn ses, %u bayt gövde\n",
+                recordBytesToSeconds(min(audioBytes, recordByteCount())),
+                (unsigned)body.size());
+
+  unsigned long t0 = millis();
+  uint32_t left = netMsLeft(deadline);
+  if (left == 0)
+    return "";
   HTTPClient http;
+  http.setReuse(true);
 
   String url = String(STT_URL_BASE) + String(googleApiKey);
   http.begin(client, url);
   http.addHeader("Content-Type", "application/json");
-  http.setTimeout(15000);
+  http.setConnectTimeout(left);
+  http.setTimeout((uint16_t)left);
+  body.setDeadline(deadline, cancel);
 
-  int code = http.POST((uint8_t *)bodyBuf, strlen(bodyBuf));
-  free(bodyBuf);
+  int code = http.sendRequest("POST", &body, body.size());
 
   String response = "";
+  bool cut = body.expired();
   if (code == 200) {
     DynamicJsonDocument doc(4096);
-    DeserializationError err = deserializeJson(doc, http.getStream());
+    DeadlineStream in(http.getStream(), deadline, cancel);
+    DeserializationError err = deserializeJson(doc, in);
+    cut = in.expired();
     if (!err) {
       auto t = doc["results"][0]["alternatives"][0]["transcript"];
       if (!t.isNull())
@@ -458,354 +1859,2847 @@ String speechToText() {
   }
 
   http.end();
+  if (cut) {
+    Serial.println("[STT] İstek kesildi, bağlantı kapatıldı.");
+    client.stop(); // Yarım kalan cevap sonraki isteğe karışmasın
+    response = "";
+  }
+  metricsStage(METRIC_STT, t0, code);
   return response;
 }
 
+#ifdef USE_SPECULATIVE_STT
+// ============================================
+//  SPEKÜLATİF STT
+// ============================================
+void sttSpecTask(void *arg) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    String text =
+        sttPost(sttSpecClient, sttSpec.bytes,
+                millis() + STT_SPECULATIVE_TIMEOUT_MS, &sttSpec.cancel);
+    if (sttSpec.cancel)
+      sttSpecClient.stop(); // Kayıt bitti: TLS oturumu iç RAM'i geri versin
+    sttSpec.transcript = text;
+    __atomic_store_n(&sttSpec.busy, false, __ATOMIC_RELEASE);
+    xSemaphoreGive(sttSpec.done);
+  }
+}
+
+void sttSpecInit() {
+  sttSpecClient.setInsecure();
+  sttSpecClient.setHandshakeTimeout(NET_HANDSHAKE_TIMEOUT_S);
+  sttSpec.done = xSemaphoreCreateBinary();
+  if (!sttSpec.done ||
+      xTaskCreatePinnedToCore(sttSpecTask, "stt_spec", STT_SPECULATIVE_STACK,
+                              NULL, 2, &sttSpec.task, 0) != pdPASS) {
+    Serial.println("[STT] Spekülatif görev başlatılamadı, kapalı.");
+    sttSpec.task = NULL;
+  }
+}
+
+// LISTENING'de her blokta: duraklama STT_SPECULATIVE_PAUSE_MS'i geçince
+// o ana kadarki kaydı gönderir (duraklama başına bir kez)
+void sttSpecPoll() {
+  if (sttSpec.task == NULL || WiFi.status() != WL_CONNECTED)
+    return;
+  if (millis() - lastSoundTime < STT_SPECULATIVE_PAUSE_MS)
+    return;
+  if (sttSpec.pending && sttSpec.lastSound == lastSoundTime)
+    return; // Bu duraklama için zaten gönderildi
+  if (__atomic_load_n(&sttSpec.busy, __ATOMIC_ACQUIRE))
+    return; // Önceki (boşa giden) istek sürüyor; sonda tam kayıt gider
+  if (recordSampleCount() < (size_t)SAMPLE_RATE * STT_SPECULATIVE_MIN_MS / 1000)
+    return;
+  // Görev boşta: istemciye ana döngüden bakmak güvenli
+  if (!sttSpecClient.connected() &&
+      ESP.getFreeHeap() < STT_SPECULATIVE_MIN_HEAP)
+    return; // İkinci TLS oturumuna yer yok; sonda tam kayıt gider
+  if (sttSpec.pending)
+    sttSpec.wasted++; // Önceki duraklamadan sonra konuşma sürmüştü
+
+  xSemaphoreTake(sttSpec.done, 0); // Eski istekten kalan sinyal
+  sttSpec.pending = true;
+  sttSpec.lastSound = lastSoundTime;
+  sttSpec.sentAt = millis();
+  sttSpec.bytes = recordByteCount();
+  sttSpec.cancel = false;
+  sttSpec.busy = true;
+  sttSpec.sent++;
+  Serial.printf("[STT] Spekülatif: %lu ms duraklama, %.1f sn ses gönderildi\n",
+                millis() - lastSoundTime,
+                (float)recordSampleCount() / SAMPLE_RATE);
+  xTaskNotifyGive(sttSpec.task);
+}
+
+// Kayıt bitince: son duraklamada gönderilen istek sonrası konuşma yoksa
+// sonucunu bekleyip kullanır. false: tam kayıt gönderilmeli.
+bool sttSpecTake(String &transcript) {
+  if (!sttSpec.pending)
+    return false;
+  sttSpec.pending = false;
+  if (sttSpec.lastSound != lastSoundTime) {
+    sttSpec.wasted++;
+    Serial.printf("[STT] Spekülatif sonuç atıldı: konuşma sürdü (boşa "
+                  "%u/%u)\n",
+                  sttSpec.wasted, sttSpec.sent);
+    sttSpecDrop(); // Tam kayıt isteğiyle bant genişliği paylaşmasın
+    return false;
+  }
+  unsigned long waitStart = millis();
+  if (__atomic_load_n(&sttSpec.busy, __ATOMIC_ACQUIRE))
+    xSemaphoreTake(sttSpec.done, pdMS_TO_TICKS(turnStageBudget(METRIC_STT)));
+  if (__atomic_load_n(&sttSpec.busy, __ATOMIC_ACQUIRE) ||
+      sttSpec.transcript.isEmpty()) {
+    sttSpec.failed++;
+    Serial.println("[STT] Spekülatif istek sonuç vermedi, tam kayıt "
+                   "gönderiliyor.");
+    sttSpecDrop();
+    return false;
+  }
+  transcript = sttSpec.transcript;
+  sttSpec.used++;
+  sttSpecDrop(); // Bu kayıtta başka istek yok, oturum iç RAM'i geri versin
+  // Sessizlik bitiminde gönderilseydi cevap en erken şimdi + istek süresi
+  // kadar sonra gelirdi; kazanç kabaca o süre kadardır
+  unsigned long waited = millis() - waitStart;
+  unsigned long requestMs = millis() - sttSpec.sentAt;
+  unsigned long saved = requestMs > waited ? requestMs - waited : 0;
+  sttSpec.savedMs += saved;
+  Serial.printf("[STT] Spekülatif sonuç kullanıldı: %lu ms beklendi, ~%lu ms "
+                "kazanıldı (kullanılan %u/%u, boşa %u)\n",
+                waited, saved, sttSpec.used, sttSpec.sent, sttSpec.wasted);
+  return true;
+}
+
+// Sonuç artık gerekmiyor: süren istek kesilir, boştaysa TLS oturumu
+// kapatılır. Kesme görevin bir sonraki yazma/okuma adımında görülür;
+// ana döngü en fazla STT_SPECULATIVE_DROP_WAIT_MS bekler.
+void sttSpecDrop() {
+  if (!__atomic_load_n(&sttSpec.busy, __ATOMIC_ACQUIRE)) {
+    sttSpecClient.stop(); // Görev boşta: ana döngüden kapatmak güvenli
+    return;
+  }
+  sttSpec.cancel = true;
+  xSemaphoreTake(sttSpec.done, pdMS_TO_TICKS(STT_SPECULATIVE_DROP_WAIT_MS));
+}
+
+// Kayıt silinmeden önce: kararsız istek boşa sayılır ve kesilir. Görev
+// bekleme süresinde bitmese de kayıt silinebilir: bloklar hiç free
+// edilmez (serbest liste), kesilen gövde en fazla yeni veriyi okur ve
+// sonucu kullanılmaz. Görev bitene kadar yeni spekülasyon başlamaz (busy).
+void sttSpecDiscard() {
+  if (sttSpec.pending) {
+    sttSpec.pending = false;
+    sttSpec.wasted++;
+  }
+  sttSpecDrop();
+}
+#endif
+
+#ifdef USE_STREAMING_STT
+// ============================================
+//  AKIŞLI STT (köprü üzerinden streamingRecognize)
+// ============================================
+// Google streamingRecognize gRPC/HTTP2 ister; cihaz onu düz TCP üzerinden
+// çeviren bir köprüye bağlanır. Protokol:
+//   cihaz -> köprü: tek satır JSON yapılandırma
+//     {"encoding":"MULAW","sampleRateHertz":16000,"languageCode":"tr-TR",
+//      "singleUtterance":true,"interimResults":true}\n
+//   ardından çerçeveler: [uint16 LE uzunluk][ses baytları], uzunluk 0 = son
+//   köprü -> cihaz: satır başına bir StreamingRecognizeResponse (JSON),
+//     {"speechEventType":"END_OF_SINGLE_UTTERANCE"} ve
+//     {"results":[{"alternatives":[{"transcript":"..."}],"isFinal":true}]}
+// Test için aynı protokolü konuşan yerel sunucu: tools/stt_bridge_stub.cpp
+bool sttStreamConfigured() {
+  return !(String(STREAM_STT_HOST) == "YOUR_STREAM_BRIDGE_HERE" ||
+           String(STREAM_STT_HOST) == "");
+}
+
+// Kayıt bloklarından sıradaki baytları kopyalar (kayıt büyümeye devam eder)
+size_t sttStreamCopy(RecordBlock *&block, size_t &pos, uint8_t *dst,
+                     size_t max) {
+  size_t copied = 0;
+  while (copied < max) {
+    if (!block)
+      block = recordStore.head;
+    if (!block)
+      break;
+    size_t used = block->used;
+    if (pos >= used) {
+      if (!block->next)
+        break;
+      block = block->next;
+      pos = 0;
+      continue;
+    }
+    size_t k = min(max - copied, used - pos);
+    memcpy(dst + copied, block->data + pos, k);
+    copied += k;
+    pos += k;
+  }
+  return copied;
+}
+
+bool sttStreamSendFrame(WiFiClient &client, const uint8_t *data, size_t n) {
+  uint8_t hdr[2] = {(uint8_t)(n & 0xFF), (uint8_t)(n >> 8)};
+  if (client.write(hdr, 2) != 2)
+    return false;
+  return n == 0 || client.write(data, n) == n;
+}
+
+void sttStreamHandleLine(const String &line) {
+  DynamicJsonDocument doc(1024);
+  if (deserializeJson(doc, line)) {
+    Serial.printf("[STTa] Çözülemeyen satır: %s\n", line.c_str());
+    return;
+  }
+  if (!doc["error"].isNull()) {
+    Serial.printf("[STTa] Köprü hatası: %s\n",
+                  doc["error"]["message"].as<String>().c_str());
+    sttStream.failed = true;
+    return;
+  }
+  if (doc["speechEventType"].as<String>() == "END_OF_SINGLE_UTTERANCE" &&
+      !sttStream.endOfUtterance) {
+    sttStream.endOfUtterance = true;
+    Serial.printf("[STTa] Sunucu: konuşma bitti (%lu ms)\n",
+                  millis() - sttStream.startedAt);
+  }
+  JsonVariant result = doc["results"][0];
+  if (result.isNull())
+    return;
+  String text = result["alternatives"][0]["transcript"].as<String>();
+  if (result["isFinal"].as<bool>()) {
+    sttStream.finalText += text;
+    sttStream.finalReady = true;
+  } else {
+    Serial.println("[STTa] Ara: " + text);
+  }
+}
+
+void sttStreamTask(void *arg) {
+  static uint8_t frame[STREAM_STT_FRAME_BYTES];
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    WiFiClient client;
+    if (!client.connect(STREAM_STT_HOST, STREAM_STT_PORT,
+                        STREAM_STT_CONNECT_TIMEOUT_MS)) {
+      Serial.println("[STTa] Köprüye bağlanılamadı, senkron STT kullanılacak.");
+      sttStream.failed = true;
+    } else {
+      client.setNoDelay(true);
+#ifdef RECORD_MULAW
+      const char *encoding = "MULAW";
+#else
+      const char *encoding = "LINEAR16";
+#endif
+      client.printf("{\"encoding\":\"%s\",\"sampleRateHertz\":%d,"
+                    "\"languageCode\":\"tr-TR\",\"singleUtterance\":true,"
+                    "\"interimResults\":true}\n",
+                    encoding, SAMPLE_RATE);
+
+      RecordBlock *block = NULL;
+      size_t pos = 0;
+      bool audioDone = false;
+      unsigned long audioDoneAt = 0;
+      String line;
+      while (!sttStream.failed && !sttStream.finalReady &&
+             !sttStream.cancel) {
+        if (!audioDone) {
+          size_t n;
+          while ((n = sttStreamCopy(block, pos, frame, sizeof(frame))) > 0) {
+            if (!sttStreamSendFrame(client, frame, n)) {
+              sttStream.failed = true;
+              break;
+            }
+          }
+          if (sttStream.stop || sttStream.endOfUtterance) {
+            sttStreamSendFrame(client, NULL, 0);
+            audioDone = true;
+            audioDoneAt = millis();
+          }
+        }
+        while (client.available() && !sttStream.cancel) {
+          char c = client.read();
+          if (c == '\n') {
+            sttStreamHandleLine(line);
+            line = "";
+          } else {
+            line += c;
+          }
+        }
+        if (!client.connected() && !client.available()) {
+          Serial.println("[STTa] Köprü bağlantısı koptu.");
+          sttStream.failed = true;
+        }
+        if (audioDone &&
+            millis() - audioDoneAt > STREAM_STT_FINAL_TIMEOUT_MS) {
+          Serial.println("[STTa] Son sonuç gelmedi.");
+          break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(STREAM_STT_POLL_MS));
+      }
+      client.stop();
+    }
+    __atomic_store_n(&sttStream.active, false, __ATOMIC_RELEASE);
+    xSemaphoreGive(sttStream.done);
+  }
+}
+
+void sttStreamInit() {
+  if (!sttStreamConfigured()) {
+    Serial.println("[STTa] Köprü ayarlı değil, akışlı tanıma kapalı.");
+    return;
+  }
+  sttStream.done = xSemaphoreCreateBinary();
+  if (!sttStream.done ||
+      xTaskCreatePinnedToCore(sttStreamTask, "stt_stream", STREAM_STT_STACK,
+                              NULL, 3, &sttStream.task, 0) != pdPASS) {
+    Serial.println("[STTa] Görev başlatılamadı, akışlı tanıma kapalı.");
+    sttStream.task = NULL;
+  }
+}
+
+// Kaydın ilk bloğundan hemen önce çağrılır
+void sttStreamBegin() {
+  if (sttStream.task == NULL || WiFi.status() != WL_CONNECTED)
+    return;
+  // Önceki oturum tamamen bitmiş olmalı; bağlanırken takıldıysa bu kayıt
+  // akışsız (RMS sessizliği + senkron STT) yapılır
+  if (!sttStreamDiscard()) {
+    Serial.println("[STTa] Önceki oturum kapanmadı, bu kayıt akışsız.");
+    return;
+  }
+  xSemaphoreTake(sttStream.done, 0);
+  sttStream.stop = false;
+  sttStream.cancel = false;
+  sttStream.endOfUtterance = false;
+  sttStream.failed = false;
+  sttStream.finalReady = false;
+  sttStream.finalText = "";
+  sttStream.startedAt = millis();
+  sttStream.active = true;
+  sttStream.sessions++;
+  xTaskNotifyGive(sttStream.task);
+}
+
+// Oturum bu kayıt için sürüyor ve hata yok: sunucu konuşma sonunu bildirecek
+bool sttStreamHealthy() {
+  return __atomic_load_n(&sttStream.active, __ATOMIC_ACQUIRE) &&
+         !sttStream.failed && !sttStream.stop;
+}
+
+// Kayıt bitince: son sonucu bekler. false: senkron STT'ye düşülmeli.
+bool sttStreamTake(String &transcript) {
+  if (!sttStreamHealthy())
+    return false;
+  bool serverEnd = sttStream.endOfUtterance;
+  if (serverEnd)
+    sttStream.serverEnds++;
+  sttStream.stop = true;
+
+  unsigned long t0 = millis();
+  uint32_t budget = turnStageBudget(METRIC_STT);
+  while (__atomic_load_n(&sttStream.active, __ATOMIC_ACQUIRE) &&
+         !sttStream.finalReady && millis() - t0 < budget)
+    xSemaphoreTake(sttStream.done, pdMS_TO_TICKS(STREAM_STT_POLL_MS));
+
+  if (!sttStream.finalReady || sttStream.finalText.isEmpty()) {
+    sttStream.fallbacks++;
+    Serial.printf("[STTa] Son sonuç yok, senkron STT (yedek %u/%u)\n",
+                  sttStream.fallbacks, sttStream.sessions);
+    return false;
+  }
+  // Görev son sonuçtan sonra finalText'e dokunmaz
+  transcript = sttStream.finalText;
+  sttStream.used++;
+  metricsStage(METRIC_STT, t0, 200);
+  Serial.printf("[STTa] Son sonuç kayıt bitiminden %lu ms sonra (%s)\n",
+                millis() - t0, serverEnd ? "sunucu bitirdi" : "sessizlik");
+  return true;
+}
+
+// Kayıt silinmeden önce görev blokları okumayı bırakmalı. Görev
+// client.connect içindeyse (STREAM_STT_CONNECT_TIMEOUT_MS) ana döngü
+// beklemez: bloklar serbest bırakılmaz, görev dönünce cancel'ı görüp çıkar.
+// false: görev hâlâ çalışıyor, yeni oturum başlatılmamalı
+bool sttStreamDiscard() {
+  if (!__atomic_load_n(&sttStream.active, __ATOMIC_ACQUIRE))
+    return true;
+  sttStream.cancel = true;
+  sttStream.stop = true;
+  unsigned long t0 = millis();
+  while (__atomic_load_n(&sttStream.active, __ATOMIC_ACQUIRE) &&
+         millis() - t0 < STREAM_STT_DISCARD_WAIT_MS)
+    xSemaphoreTake(sttStream.done, pdMS_TO_TICKS(STREAM_STT_POLL_MS));
+  return !__atomic_load_n(&sttStream.active, __ATOMIC_ACQUIRE);
+}
+#endif
+
 // ============================================
 //  GEMİNİ 1.5 FLASH
 // ============================================
-String askGemini(const String &userText) {
-  Serial.println("[Gemini] İstek gönderiliyor...");
+// Değişmeyen kısım (sistem talimatı + işlev bildirimi) kayıttan bir kez
+// üretilir; her istekte sadece kullanıcı metni serileştirilir.
+String geminiBody(const String &userText) {
+  DynamicJsonDocument doc(userText.length() + 256);
+  doc["contents"][0]["role"] = "user";
+  doc["contents"][0]["parts"][0]["text"] = userText;
+  String body;
+  serializeJson(doc, body);
+  body.remove(body.length() - 1); // Kapanan '}'
+  body += "," + geminiStatic + "}";
+  return body;
+}
+
+// functionCall parçası: kayıtta olmayan cihaz/eylem sessizce düşmez, loglanır
+void geminiTakeCall(JsonVariant call, GeminiReply &reply) {
+  String name = call["name"].as<String>();
+  String device = call["args"]["device"].as<String>();
+  String action = call["args"]["action"].as<String>();
+  const SmartDevice *d = deviceFind(device.c_str());
+  int a = deviceActionIndex(action.c_str());
+  if (name != "set_device" || !d || a < 0 || !(d->actions & (1 << a))) {
+    Serial.printf("[Gemini] Geçersiz işlev çağrısı atlandı: %s(%s, %s)\n",
+                  name.c_str(), device.c_str(), action.c_str());
+    return;
+  }
+  if (reply.actionCount >= SMART_HOME_MAX_ACTIONS)
+    return;
+  SmartHomeAction &act = reply.actions[reply.actionCount++];
+  action.toCharArray(act.cmd, sizeof(act.cmd));
+  device.toCharArray(act.device, sizeof(act.device));
+}
 
-  String body =
-      "\"Sen Alex adinda Turkce konusan yardimci bir sesli asistansin. "
-      "Eger kullanici bir akilli ev cihazini acip kapatmak isterse (isik, priz "
-      "vb.), "
-      "sohbet etmek yerine SADECE su JSON formatini dondur: "
-      "{\\\"cmd\\\": \\\"eylem_adi\\\", \\\"device\\\": \\\"cihaz_adi\\\", "
-      "\\\"speech\\\": \\\"kisa_onay_cumlesi\\\"} "
-      "Eylem ornekleri: turn_on, turn_off. Cihaz ornekleri: living_room_light, "
-      "kitchen_socket. "
-      "Sohbet ise kisa ve net normal cevap ver. Kullanici: " +
-      userText + "\"}]}]}";
-
-  WiFiClientSecure client;
-  client.setInsecure();
+// Tek bir deneme; hedge görevinden de çağrılır (kendi istemcisiyle).
+// deadline: mutlak bitiş anı. cancel: hedge'de kaybeden denemeyi keser.
+bool geminiRequest(const String &body, WiFiClientSecure &client,
+                   unsigned long deadline, GeminiReply &reply,
+                   const volatile bool *cancel = NULL) {
+  reply.text = "";
+  reply.actionCount = 0;
+  uint32_t left = netMsLeft(deadline);
+  if (left == 0)
+    return false;
   HTTPClient http;
+  http.setReuse(true);
 
+  unsigned long t0 = millis();
   String url = String(LLM_URL_BASE) + String(googleApiKey);
   http.begin(client, url);
   http.addHeader("Content-Type", "application/json");
-  http.setTimeout(20000);
+  http.setConnectTimeout(left);
+  http.setTimeout((uint16_t)left);
 
   int code = http.POST(body);
-  String response = "";
 
+  bool cut = false;
   if (code == 200) {
     DynamicJsonDocument doc(8192);
-    DeserializationError err = deserializeJson(doc, http.getStream());
+    DeadlineStream in(http.getStream(), deadline, cancel);
+    DeserializationError err = deserializeJson(doc, in);
+    cut = in.expired();
     if (!err) {
-      auto t = doc["candidates"][0]["content"]["parts"][0]["text"];
-      if (!t.isNull()) {
-        response = t.as<String>();
-        if (response.length() > 500)
-          response = response.substring(0, 500);
+      JsonArray parts =
+          doc["candidates"][0]["content"]["parts"].as<JsonArray>();
+      for (JsonVariant part : parts) {
+        if (!part["functionCall"].isNull())
+          geminiTakeCall(part["functionCall"], reply);
+        else if (!part["text"].isNull())
+          reply.text += part["text"].as<String>();
+      }
+      if (reply.text.length() > GEMINI_MAX_ANSWER_CHARS) {
+        // Kelime ortasında değil, son tam cümlede kes
+        int cut = ttsBreakPoint(reply.text, GEMINI_MAX_ANSWER_CHARS);
+        reply.text = reply.text.substring(0, cut);
+        reply.text.trim();
       }
     } else {
       Serial.printf("[Gemini] JSON hatası: %s\n", err.c_str());
     }
-  } else {
-    Serial.printf("[Gemini] HTTP Hata: %d\n", code);
+  } else {
+    Serial.printf("[Gemini] HTTP Hata: %d\n", code);
+  }
+
+  http.end();
+  if (cut) {
+    client.stop(); // Yarım kalan cevap sonraki isteğe karışmasın
+    reply.text = "";
+    reply.actionCount = 0;
+  }
+  metricsStage(METRIC_LLM, t0, code);
+  return !reply.text.isEmpty() || reply.actionCount > 0;
+}
+
+#ifdef USE_HEDGING
+// İki deneme ve bekleyen çağıran arasında paylaşılır; son bırakan siler
+struct HedgeCall {
+  String body;
+  unsigned long deadline; // Mutlak; iki deneme de bunu aşamaz
+  volatile bool cancel;   // Kazanan belli oldu / çağıran vazgeçti
+  GeminiReply result[2];
+  volatile int winner; // -1: henüz yok
+  uint8_t refs;
+  SemaphoreHandle_t done; // Her deneme bitince bir kez verilir
+  portMUX_TYPE mux;
+};
+
+void hedgeRelease(HedgeCall *call) {
+  if (__atomic_sub_fetch(&call->refs, 1, __ATOMIC_ACQ_REL) != 0)
+    return;
+  vSemaphoreDelete(call->done);
+  delete call;
+}
+
+void hedgeFinish(HedgeCall *call, int attempt, bool ok) {
+  portENTER_CRITICAL(&call->mux);
+  if (call->winner < 0 && ok)
+    call->winner = attempt;
+  portEXIT_CRITICAL(&call->mux);
+  xSemaphoreGive(call->done);
+  hedgeRelease(call);
+}
+
+// Asıl istek: ısıtılmış kalıcı bağlantıyı kullanır
+void hedgePrimaryTask(void *arg) {
+  HedgeCall *call = (HedgeCall *)arg;
+  bool ok;
+  {
+    NetLease lease(NET_HOST_LLM, netMsLeft(call->deadline));
+    ok = lease.client && geminiRequest(call->body, *lease.client,
+                                       call->deadline, call->result[0],
+                                       &call->cancel);
+  }
+  hedgeFinish(call, 0, ok);
+  vTaskDelete(NULL);
+}
+
+// Yedek istek: asıl bağlantı meşgul olduğu için yeni bir TLS oturumu
+void hedgeBackupTask(void *arg) {
+  HedgeCall *call = (HedgeCall *)arg;
+  bool ok;
+  {
+    WiFiClientSecure client;
+    client.setInsecure();
+    client.setHandshakeTimeout(NET_HANDSHAKE_TIMEOUT_S);
+    ok = geminiRequest(call->body, client, call->deadline, call->result[1],
+                       &call->cancel);
+  } // Yedek oturum burada kapanır, iç RAM geri verilir
+  hedgeFinish(call, 1, ok);
+  vTaskDelete(NULL);
+}
+
+bool hedgeStart(HedgeCall *call, TaskFunction_t fn, const char *name) {
+  __atomic_add_fetch(&call->refs, 1, __ATOMIC_ACQ_REL);
+  if (xTaskCreatePinnedToCore(fn, name, HEDGE_TASK_STACK, call, 2, NULL, 0) ==
+      pdPASS)
+    return true;
+  hedgeRelease(call);
+  return false;
+}
+
+// Asıl istek hedgeAfterMs içinde dönmezse yedeği başlatır; ilk dolu cevap
+bool geminiHedged(const String &body, uint32_t budget, uint32_t hedgeAfterMs,
+                  GeminiReply &reply) {
+  unsigned long deadline = millis() + budget;
+  HedgeCall *call = new HedgeCall();
+  call->body = body;
+  call->deadline = deadline;
+  call->cancel = false;
+  call->winner = -1;
+  call->refs = 1; // Çağıran
+  call->done = xSemaphoreCreateCounting(2, 0);
+  call->mux = portMUX_INITIALIZER_UNLOCKED;
+  if (!call->done || !hedgeStart(call, hedgePrimaryTask, "llm_primary")) {
+    if (call->done)
+      vSemaphoreDelete(call->done);
+    delete call;
+    NetLease lease(NET_HOST_LLM, budget);
+    return lease.client && geminiRequest(body, *lease.client, deadline, reply);
+  }
+
+  int running = 1;
+  bool hedged = false;
+  for (;;) {
+    long left = (long)(deadline - millis());
+    if (left <= 0)
+      break;
+    uint32_t wait = hedged ? left : min((uint32_t)left, hedgeAfterMs);
+    if (xSemaphoreTake(call->done, pdMS_TO_TICKS(wait)) == pdTRUE) {
+      running--;
+      if (call->winner >= 0 || running == 0)
+        break;
+      continue;
+    }
+    // Hedge'in de bir şansı olmalı; yoksa asıl isteği beklemeye devam
+    if (!hedged && left > (long)TURN_MIN_STAGE_MS) {
+      hedged = true;
+      uint32_t freeHeap = ESP.getFreeHeap();
+      if (freeHeap < HEDGE_MIN_FREE_HEAP ||
+          ESP.getMaxAllocHeap() < HEDGE_MIN_HEAP_BLOCK) {
+        Serial.printf("[Gemini] İç RAM yetersiz (%u bayt), ikinci istek "
+                      "yok.\n",
+                      freeHeap);
+      } else if (hedgeStart(call, hedgeBackupTask, "llm_hedge")) {
+        running++;
+        turn.hedged++;
+        Serial.printf("[Gemini] %u ms'de cevap yok (p%d), ikinci istek "
+                      "gönderildi.\n",
+                      hedgeAfterMs, HEDGE_PERCENTILE);
+      }
+    }
+  }
+  bool ok = call->winner >= 0;
+  if (ok) {
+    reply = call->result[call->winner];
+    if (call->winner == 1) {
+      turn.hedgeWins++;
+      Serial.println("[Gemini] İkinci istek önce döndü.");
+    }
+  }
+  call->cancel = true; // Geride kalan deneme cevap okumayı bırakıp kapatır
+  hedgeRelease(call);
+  return ok;
+}
+#endif
+
+bool askGemini(const String &userText, GeminiReply &reply) {
+  Serial.println("[Gemini] İstek gönderiliyor...");
+
+  uint32_t budget = turnStageBudget(METRIC_LLM);
+  if (budget < TURN_MIN_STAGE_MS) {
+    Serial.println("[Gemini] Tur süresi doldu, gönderilmedi.");
+    return false;
+  }
+  String body = geminiBody(userText);
+
+#ifdef USE_HEDGING
+  uint32_t hedgeAfter = metricPercentileMs(
+      metrics.latency[METRIC_LLM], HEDGE_PERCENTILE, HEDGE_MIN_SAMPLES);
+  if (hedgeAfter > 0 && hedgeAfter + TURN_MIN_STAGE_MS < budget)
+    return geminiHedged(body, budget, hedgeAfter, reply);
+#endif
+
+  unsigned long deadline = millis() + budget; // Kilit beklemesi dahil
+  NetLease lease(NET_HOST_LLM, budget);
+  return lease.client && geminiRequest(body, *lease.client, deadline, reply);
+}
+
+// ============================================
+//  TEXT TO SPEECH — Yerel / Bulut seçimi
+// ============================================
+// preferLocal: kısa sistem/onay cümleleri yerelde (onlarca ms) sentezlenir.
+// Bulut başarısız olursa veya bağlantı yoksa yerel sentez yedektir.
+void textToSpeech(const String &text, bool preferLocal) {
+  bool offline = (WiFi.status() != WL_CONNECTED);
+  if ((preferLocal || offline) && localTextToSpeech(text))
+    return;
+  if (!offline && cloudTextToSpeech(text))
+    return;
+  Serial.println("[TTS] Bulut başarısız, yerel sentez deneniyor.");
+  if (!localTextToSpeech(text) && turn.active)
+    turnApology(); // Uzun cevap yerelde okunamaz; sessiz kalma
+}
+
+bool localTextToSpeech(const String &text) {
+  size_t n = 0;
+  int16_t *pcm = localTtsRender(text, n);
+  if (!pcm)
+    return false;
+  return playbackEnqueue(pcm, n, true) != 0;
+}
+
+// PSRAM'da PCM döner (çağıran free eder) ya da NULL
+int16_t *localTtsRender(const String &text, size_t &samples) {
+  if (text.length() == 0 || text.length() > LOCAL_TTS_MAX_CHARS)
+    return NULL;
+
+  // Rakamlar okunuşlarına açıldığı için metinden uzun olabilir
+  size_t normMax = text.length() * 8 + 1;
+  char *norm = (char *)memTrackAlloc(normMax, false, "yerel tts metin");
+  if (!norm)
+    return NULL;
+  ltNormalize(text.c_str(), norm, normMax);
+
+  unsigned long t0 = micros();
+  size_t maxSamples = localTtsMeasure(norm, SAMPLE_RATE);
+  int16_t *pcm = (int16_t *)memTrackAlloc(maxSamples * sizeof(int16_t), true,
+                                          "yerel tts pcm");
+  if (!pcm) {
+    Serial.println("[YerelTTS] HATA: PSRAM yetersiz!");
+    free(norm);
+    return NULL;
+  }
+  samples = localTtsSynthesize(norm, pcm, maxSamples, SAMPLE_RATE);
+  unsigned long us = micros() - t0;
+  free(norm);
+
+  float audioSec = (float)samples / SAMPLE_RATE;
+  Serial.printf("[YerelTTS] %.2f sn ses %.1f ms'de (gerçek zamanın %.1fx "
+                "hızlı)\n",
+                audioSec, us / 1000.0f, audioSec * 1e6f / (us ? us : 1));
+  return pcm;
+}
+
+// ============================================
+//  TEXT TO SPEECH — Parçalı, önden getirmeli
+// ============================================
+// Metinde limit'ten önceki en iyi kesme noktası: son cümle sonu, yoksa
+// virgül/noktalı virgül, yoksa boşluk (UTF-8 karakter asla bölünmez).
+int ttsBreakPoint(const String &text, int limit) {
+  if ((int)text.length() <= limit)
+    return text.length();
+  int comma = -1, space = -1;
+  for (int i = limit; i > 0; i--) {
+    char c = text[i - 1];
+    bool boundary = (i >= (int)text.length()) || text[i] == ' ' ||
+                    text[i] == '\n';
+    if ((c == '.' || c == '!' || c == '?' || c == '\n') && boundary)
+      return i;
+    if (comma < 0 && (c == ',' || c == ';' || c == ':') && boundary)
+      comma = i;
+    if (space < 0 && c == ' ')
+      space = i;
+  }
+  if (comma > 0)
+    return comma;
+  if (space > 0)
+    return space;
+  // Boşluksuz uzun dizi: UTF-8 devam baytında kesme
+  int i = limit;
+  while (i > 0 && ((uint8_t)text[i] & 0xC0) == 0x80)
+    i--;
+  return i > 0 ? i : limit;
+}
+
+int ttsSplitChunks(const String &text, String *chunks, int maxChunks) {
+  String rest = text;
+  rest.trim();
+  int count = 0;
+  while (rest.length() > 0 && count < maxChunks) {
+    int limit = (count == 0) ? TTS_FIRST_CHUNK_CHARS : TTS_CHUNK_MAX_CHARS;
+    if (count == maxChunks - 1)
+      limit = rest.length(); // Son parça kalanı alır
+    int cut = ttsBreakPoint(rest, limit);
+    chunks[count] = rest.substring(0, cut);
+    chunks[count].trim();
+    if (chunks[count].length() > 0)
+      count++;
+    rest = rest.substring(cut);
+    rest.trim();
+  }
+  return count;
+}
+
+// Bir parçayı buluttan sentezler; olmazsa yerel sentez
+int16_t *ttsRenderChunk(const String &text, size_t &samples) {
+  int16_t *pcm = NULL;
+  if (WiFi.status() == WL_CONNECTED)
+    pcm = cloudTtsFetch(text, samples);
+  if (!pcm)
+    pcm = localTtsRender(text, samples);
+  return pcm;
+}
+
+// Parçalar çalma motoruna sırayla verilir; parça N çalarken N+1 burada
+// sentezlenir. Çalmanın bitmesi beklenmez (bkz. finishTurn).
+bool cloudTextToSpeech(const String &text) {
+  String chunks[TTS_MAX_CHUNKS];
+  int count = ttsSplitChunks(text, chunks, TTS_MAX_CHUNKS);
+  if (count == 0)
+    return false;
+
+  unsigned long t0 = millis();
+  int played = 0;
+  for (int i = 0; i < count; i++) {
+    // Çift tampon: biri çalarken en fazla bir parça daha hazırlanır
+    playbackWaitPending(1);
+    size_t n = 0;
+    int16_t *pcm = (count == 1) ? cloudTtsFetch(chunks[i], n)
+                                : ttsRenderChunk(chunks[i], n);
+    if (!pcm) {
+      Serial.printf("[TTS] Parça %d/%d atlandı.\n", i + 1, count);
+      continue;
+    }
+    if (played == 0)
+      Serial.printf("[TTS] İlk ses: %lu ms (%d parça)\n", millis() - t0,
+                    count);
+    if (playbackEnqueue(pcm, n, true))
+      played++;
+  }
+  if (count > 1)
+    Serial.printf("[TTS] %d/%d parça sentezlendi, %lu ms\n", played, count,
+                  millis() - t0);
+  return played > 0;
+}
+
+// ============================================
+//  TEXT TO SPEECH — Stream ile PSRAM'a
+// ============================================
+// LINEAR16 cevabı WAV başlığıyla gelir; başlık ses olarak çalınırsa her
+// parçada tık duyulur. PCM'in başladığı ofseti döner (başlık yoksa 0).
+size_t wavDataOffset(const uint8_t *buf, size_t len) {
+  if (len < 12 || memcmp(buf, "RIFF", 4) != 0 || memcmp(buf + 8, "WAVE", 4))
+    return 0;
+  size_t pos = 12;
+  while (pos + 8 <= len) {
+    uint32_t size = buf[pos + 4] | buf[pos + 5] << 8 | buf[pos + 6] << 16 |
+                    (uint32_t)buf[pos + 7] << 24;
+    if (memcmp(buf + pos, "data", 4) == 0)
+      return pos + 8;
+    pos += 8 + size + (size & 1);
+  }
+  return len; // Bozuk başlık: hiç çalma
+}
+
+// PSRAM'da PCM döner (çağıran free eder) ya da NULL
+int16_t *cloudTtsFetch(const String &text, size_t &samples) {
+  Serial.printf("[TTS] Sentezleniyor (%d karakter)...\n", text.length());
+
+  DynamicJsonDocument doc(text.length() + 256);
+  doc["input"]["text"] = text;
+  doc["voice"]["languageCode"] = "tr-TR";
+  doc["voice"]["name"] = "tr-TR-Wavenet-A";
+  doc["audioConfig"]["audioEncoding"] = "LINEAR16";
+  doc["audioConfig"]["sampleRateHertz"] = SAMPLE_RATE;
+  String body;
+  serializeJson(doc, body);
+
+  // İlk parça tur bütçesinden, sonrakiler sabit süreden pay alır
+  uint32_t budget =
+      turn.active ? turnStageBudget(METRIC_TTS) : TTS_CHUNK_TIMEOUT_MS;
+  if (budget < TURN_MIN_STAGE_MS) {
+    Serial.println("[TTS] Tur süresi doldu, buluta gidilmedi.");
+    return NULL;
+  }
+
+  unsigned long t0 = millis();
+  unsigned long deadline = t0 + budget; // Kilit + bağlantı + gövde toplamı
+  NetLease lease(NET_HOST_TTS, budget);
+  uint32_t left = netMsLeft(deadline);
+  if (!lease.client || left == 0)
+    return NULL;
+  HTTPClient http;
+  http.setReuse(true);
+
+  String url = String(TTS_URL_BASE) + String(googleApiKey);
+  http.begin(*lease.client, url);
+  http.addHeader("Content-Type", "application/json");
+  http.setConnectTimeout(left);
+  http.setTimeout((uint16_t)left);
+
+  int code = http.POST(body);
+  if (code != 200) {
+    Serial.printf("[TTS] HTTP Hata: %d\n", code);
+    http.end();
+    metricsStage(METRIC_TTS, t0, code);
+    return NULL;
+  }
+
+  WiFiClient *stream = http.getStreamPtr();
+  const String token = "\"audioContent\":\"";
+  String searchBuf = "";
+  bool found = false;
+
+  while ((long)(deadline - millis()) > 0) {
+    if (!stream->available()) {
+      delay(1); // Diğer görevlere (çalma, ağ) işlemci bırak
+      continue;
+    }
+    char c = stream->read();
+    searchBuf += c;
+    if (searchBuf.length() > (unsigned)token.length())
+      searchBuf.remove(0, 1);
+    if (searchBuf == token) {
+      found = true;
+      break;
+    }
+  }
+
+  if (!found) {
+    Serial.println("[TTS] audioContent bulunamadı!");
+    http.end();
+    lease.client->stop(); // Cevap yarım kaldı, bağlantı yeniden kullanılmaz
+    metricsStage(METRIC_TTS, t0, HTTPC_ERROR_READ_TIMEOUT);
+    return NULL;
+  }
+
+  const size_t maxB64 = 300 * 1024;
+  char *b64Buf = (char *)memTrackAlloc(maxB64, true, "tts base64");
+  if (!b64Buf) {
+    Serial.println("[TTS] HATA: PSRAM yetersiz!");
+    http.end();
+    lease.client->stop(); // Gövde okunmadı, bağlantı yeniden kullanılmaz
+    metricsStage(METRIC_TTS, t0, code);
+    return NULL;
+  }
+
+  size_t b64Pos = 0;
+  bool complete = false;
+  while ((long)(deadline - millis()) > 0 && b64Pos < maxB64 - 1) {
+    if (!stream->available()) {
+      delay(1);
+      continue;
+    }
+    char c = stream->read();
+    if (c == '"') {
+      complete = true;
+      break;
+    }
+    b64Buf[b64Pos++] = c;
+  }
+  b64Buf[b64Pos] = '\0';
+  Serial.printf("[TTS] Base64 alındı: %d KB\n", b64Pos / 1024);
+  http.end();
+  if (!complete)
+    lease.client->stop(); // Süre doldu: kalan gövde sonraki isteğe karışmasın
+  metricsStage(METRIC_TTS, t0, code);
+
+  size_t maxDecoded = (b64Pos * 3) / 4;
+  uint8_t *audioBuf = (uint8_t *)memTrackAlloc(maxDecoded, true, "tts pcm");
+  if (!audioBuf) {
+    Serial.println("[TTS] HATA: Decode için PSRAM yetersiz!");
+    free(b64Buf);
+    return NULL;
+  }
+
+  size_t actualLen = base64Decode(b64Buf, b64Pos, audioBuf);
+  free(b64Buf);
+
+  size_t header = wavDataOffset(audioBuf, actualLen);
+  actualLen -= header;
+  memmove(audioBuf, audioBuf + header, actualLen);
+  samples = actualLen / sizeof(int16_t);
+  Serial.printf("[TTS] Ses hazır: %.1f sn\n", (float)samples / SAMPLE_RATE);
+  return (int16_t *)audioBuf;
+}
+
+// ============================================
+//  ÇALMA MOTORU
+// ============================================
+// Motor görevine özel (sadece playbackTask içinden dokunulur)
+EarconVoice earconVoice = {NULL, NULL, 0, 0, 0, 0, {0, 0}};
+int16_t playbackMix[BUFFER_LENGTH];
+
+// Motor bloğu = hoparlör DMA bloğu (BUFFER_LENGTH ile sınırlı)
+size_t playbackBlockSamples() {
+  size_t n = spkHealth.profile.dmaBufLen;
+  return n < BUFFER_LENGTH ? n : BUFFER_LENGTH;
+}
+
+bool earconActive() { return earconVoice.sound != NULL; }
+
+void earconApplyRequest() {
+  if (!earconRequestPending)
+    return;
+  portENTER_CRITICAL(&playbackMux);
+  earconVoice = earconRequest;
+  earconRequestPending = false;
+  portEXIT_CRITICAL(&playbackMux);
+}
+
+// İlk gerçek ses (TTS) gelince düşünme döngüsü susar
+void earconStopLoop() {
+  if (earconVoice.sound == earconVoice.loopSound)
+    earconVoice.sound = NULL;
+  earconVoice.loopSound = NULL;
+}
+
+// Efekt sesini bloğa doygun toplama ile ekler
+void earconMix(int16_t *out, size_t n) {
+  EarconVoice &v = earconVoice;
+  for (size_t i = 0; i < n && v.sound; i++) {
+    if (v.gapLeft > 0) {
+      v.gapLeft--;
+      continue;
+    }
+    int32_t x = adpcmNext(v.adpcm, v.sound->adpcm, v.pos);
+    bool looping = (v.sound == v.loopSound);
+    x = (x * (looping ? v.loopGain : v.gain)) >> 15;
+    out[i] = afeSaturate16((int32_t)out[i] + x);
+    if (++v.pos >= v.sound->samples) {
+      v.pos = 0;
+      adpcmReset(v.adpcm);
+      v.sound = v.loopSound;
+      v.gapLeft = (uint32_t)EARCON_LOOP_GAP_MS * SAMPLE_RATE / 1000;
+    }
+  }
+}
+
+// Karıştırıp DMA'ya yazar (DMA'da yer açılana kadar bloklar)
+bool playbackWriteBlock(int16_t *mix, size_t n) {
+  earconMix(mix, n);
+
+  // Blok tepe değeri -> LED zarfı
+  int peak = 0;
+  for (size_t i = 0; i < n; i++) {
+    int v = abs(mix[i]);
+    if (v > peak)
+      peak = v;
+  }
+  playbackEnvelope = (uint8_t)min(peak >> 7, 255);
+
+  size_t written = 0;
+  esp_err_t err =
+      i2s_write(SPK_PORT, mix, n * sizeof(int16_t), &written, portMAX_DELAY);
+  if (err != ESP_OK || written == 0) {
+    Serial.printf("[SPK] i2s_write hatası: %s\n", esp_err_to_name(err));
+    return false;
+  }
+  return true;
+}
+
+void playbackRelease(PlaybackItem &it, size_t played) {
+  if (it.cb)
+    it.cb(it.id, played, it.samples, true, it.ctx);
+  if (it.owned)
+    free(it.pcm);
+  portENTER_CRITICAL(&playbackMux);
+  playbackPending--;
+  portEXIT_CRITICAL(&playbackMux);
+}
+
+// Tek tampon; durdurulursa false
+bool playbackPlayItem(PlaybackItem &it) {
+  const size_t block = playbackBlockSamples();
+  size_t offset = 0;
+  unsigned long lastProgress = millis();
+  while (offset < it.samples) {
+    if (it.generation != playbackGeneration) {
+      playbackRelease(it, offset);
+      return false;
+    }
+    earconApplyRequest();
+    size_t n = min(block, it.samples - offset);
+    memcpy(playbackMix, it.pcm + offset, n * sizeof(int16_t));
+    if (!playbackWriteBlock(playbackMix, n))
+      break;
+    offset += n;
+
+    if (it.cb && millis() - lastProgress >= PLAYBACK_PROGRESS_MS) {
+      lastProgress = millis();
+      it.cb(it.id, offset, it.samples, false, it.ctx);
+    }
+  }
+  playbackRelease(it, offset);
+  return true;
+}
+
+void playbackTask(void *arg) {
+  bool streaming = false; // Son tampondan sonra dolgu süresi içinde miyiz
+  bool filling = false;   // Bu boşlukta sessizlik yazıldı mı
+  unsigned long gapStart = 0;
+
+  for (;;) {
+    const size_t block = playbackBlockSamples();
+    const float blockMs = (float)block * 1000.0f / SAMPLE_RATE;
+    earconApplyRequest();
+
+    // Efekt çalıyorsa bekleme yok; değilse DMA kurumadan hemen önce uyan
+    TickType_t wait = portMAX_DELAY;
+    if (earconActive()) {
+      wait = 0;
+    } else if (streaming) {
+      float ms = audioPortDelayMs(spkHealth) - blockMs;
+      wait = pdMS_TO_TICKS(filling ? (uint32_t)blockMs
+                                   : (ms > blockMs ? (uint32_t)ms
+                                                   : (uint32_t)blockMs));
+    }
+
+    PlaybackItem it;
+    if (xQueueReceive(playbackQueue, &it, wait) != pdTRUE) {
+      if (earconActive()) {
+        memset(playbackMix, 0, block * sizeof(int16_t));
+        playbackActive = true;
+        playbackWriteBlock(playbackMix, block);
+        streaming = true;
+        gapStart = millis();
+        continue;
+      }
+      if (millis() - gapStart < PLAYBACK_GAP_FILL_MS) {
+        memset(playbackMix, 0, block * sizeof(int16_t));
+        size_t written = 0;
+        i2s_write(SPK_PORT, playbackMix, block * sizeof(int16_t), &written,
+                  portMAX_DELAY);
+        playbackStats.silenceBlocks++;
+        filling = true;
+      } else {
+        streaming = filling = false;
+        playbackActive = false;
+      }
+      playbackEnvelope = 0;
+      continue;
+    }
+
+    if (it.pcm == NULL)
+      continue; // earconPlay() uyandırması
+    if (it.generation != playbackGeneration) {
+      playbackRelease(it, 0); // stop() öncesi kuyruğa girmiş
+      continue;
+    }
+    if (filling)
+      playbackStats.underruns++; // Üretici DMA'ya yetişemedi
+    earconApplyRequest();
+    earconStopLoop();
+    playbackActive = true;
+    playbackStats.buffers++;
+    if (!playbackPlayItem(it))
+      playbackStats.stopped++;
+    playbackEnvelope = 0;
+    streaming = true;
+    filling = false;
+    gapStart = millis();
+  }
+}
+
+void playbackInit() {
+  playbackQueue = xQueueCreate(PLAYBACK_QUEUE_LEN, sizeof(PlaybackItem));
+  // Ağ görevlerinin (TLS) önüne geçsin diye daha yüksek öncelik
+  xTaskCreatePinnedToCore(playbackTask, "playback", PLAYBACK_STACK, NULL, 5,
+                          NULL, 0);
+}
+
+// Bloklamaz. Kimlik (0: kuyruk dolu) döner; owned ise tampon her durumda
+// motora geçer (hata olsa da serbest bırakılır).
+uint32_t playbackEnqueue(int16_t *pcm, size_t samples, bool owned,
+                         PlaybackCallback cb, void *ctx) {
+  PlaybackItem it = {pcm, samples, owned, 0, playbackGeneration, cb, ctx};
+  portENTER_CRITICAL(&playbackMux);
+  it.id = playbackNextId++;
+  playbackPending++;
+  portEXIT_CRITICAL(&playbackMux);
+
+  if (playbackQueue == NULL ||
+      xQueueSend(playbackQueue, &it, 0) != pdTRUE) {
+    Serial.println("[SPK] HATA: Çalma kuyruğu dolu, tampon atlandı!");
+    playbackRelease(it, 0);
+    return 0;
+  }
+  Serial.printf("[SPK] Kuyrukta: %.1f sn (#%u)\n",
+                (float)samples / SAMPLE_RATE, it.id);
+  if (turn.active)
+    turnFirstAudio();
+  return it.id;
+}
+
+// Bloklamaz; motor bir sonraki blokta (en geç bir DMA bloğu) çalmaya başlar
+void earconPlay(const Earcon *sound, const Earcon *loopSound) {
+  portENTER_CRITICAL(&playbackMux);
+  earconRequest.sound = sound;
+  earconRequest.loopSound = loopSound;
+  earconRequest.gain = EARCON_GAIN_Q15;
+  earconRequest.loopGain = EARCON_LOOP_GAIN_Q15;
+  earconRequest.pos = 0;
+  earconRequest.gapLeft = 0;
+  adpcmReset(earconRequest.adpcm);
+  earconRequestPending = true;
+  portEXIT_CRITICAL(&playbackMux);
+
+  // Kuyrukta bekleyen motoru uyandır (pcm == NULL: ses değil)
+  PlaybackItem wake = {NULL, 0, false, 0, playbackGeneration, NULL, NULL};
+  if (playbackQueue)
+    xQueueSend(playbackQueue, &wake, 0);
+}
+
+void earconStop() { earconPlay(NULL, NULL); }
+
+// Çalanı keser, kuyruktakileri atar (motor görevi serbest bırakır)
+void playbackStop() {
+  portENTER_CRITICAL(&playbackMux);
+  playbackGeneration++;
+  portEXIT_CRITICAL(&playbackMux);
+  i2s_zero_dma_buffer(SPK_PORT);
+}
+
+// Kuyruktaki tampon sayısı maxPending'e inene kadar bekler
+bool playbackWaitPending(uint32_t maxPending, uint32_t timeoutMs) {
+  unsigned long start = millis();
+  while (playbackPending > maxPending) {
+    if (millis() - start > timeoutMs)
+      return false;
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  return true;
+}
+
+// Her şey çalınıp DMA da boşalana kadar bekler
+bool playbackFlush(uint32_t timeoutMs) {
+  if (!playbackWaitPending(0, timeoutMs))
+    return false;
+  vTaskDelay(pdMS_TO_TICKS((uint32_t)audioPortDelayMs(spkHealth)));
+  return true;
+}
+
+// ============================================
+//  WI-FI & AYARLAR (WiFiManager)
+// ============================================
+void wifi_connect() {
+  WiFi.mode(WIFI_STA);
+
+  // 1. Ayarları Oku
+  preferences.begin("alex-config", false);
+  String gKey = preferences.getString("g_key", "");
+  String pKey = preferences.getString("p_key", "");
+  String wUrl = preferences.getString("w_url", "");
+
+  if (gKey.length() > 0)
+    gKey.toCharArray(googleApiKey, 100);
+  if (pKey.length() > 0)
+    pKey.toCharArray(picovoiceKey, 100);
+  if (wUrl.length() > 0)
+    wUrl.toCharArray(webhookUrl, 150);
+
+  // 2. WiFiManager Parametreleri
+  WiFiManager wm;
+
+  // Özel Parametre kutucukları
+  WiFiManagerParameter custom_g_key("g_key", "Google API Key", googleApiKey,
+                                    100);
+  WiFiManagerParameter custom_p_key("p_key", "Picovoice AccessKey",
+                                    picovoiceKey, 100);
+  WiFiManagerParameter custom_w_url("w_url", "Webhook URL", webhookUrl, 150);
+
+  wm.addParameter(&custom_g_key);
+  wm.addParameter(&custom_p_key);
+  wm.addParameter(&custom_w_url);
+
+  // Bağlanmaya çalış veya AP aç
+  Serial.println("[WiFi] Bağlanılıyor veya AP açılıyor...");
+
+  // Eğer daha önce kaydedilmiş ağ varsa bağlanır, yoksa "Alex_Setup" ağı kurar.
+  bool res = wm.autoConnect("Alex_Setup"); // Şifresiz AP
+
+  if (!res) {
+    Serial.println("[WiFi] Bağlantı Hatası veya TimeOut");
+    // ESP.restart(); // İsterseniz reset attırabilirsiniz
+  } else {
+    Serial.println("[WiFi] Bağlandı!");
+
+    // 3. Yeni girilen değerleri kaydet (Eğer değiştiyse)
+    String newGKey = custom_g_key.getValue();
+    String newPKey = custom_p_key.getValue();
+    String newWUrl = custom_w_url.getValue();
+
+    if (newGKey != gKey || newPKey != pKey || newWUrl != wUrl) {
+      Serial.println("[Ayarlar] Yeni değerler kaydediliyor...");
+      preferences.putString("g_key", newGKey);
+      preferences.putString("p_key", newPKey);
+      preferences.putString("w_url", newWUrl);
+
+      // RAM'deki değişkenleri de güncelle
+      newGKey.toCharArray(googleApiKey, 100);
+      newPKey.toCharArray(picovoiceKey, 100);
+      newWUrl.toCharArray(webhookUrl, 150);
+    }
+  }
+  preferences.end();
+
+  Serial.printf("[WiFi] IP: %s\n", WiFi.localIP().toString().c_str());
+}
+
+// ============================================
+//  AKILLI EV (WEBHOOK) TETİKLEME
+// ============================================
+bool webhookConfigured() {
+  return !(String(SMART_HOME_WEBHOOK_URL) == "YOUR_WEBHOOK_URL_HERE" ||
+           String(SMART_HOME_WEBHOOK_URL) == "");
+}
+
+bool mqttConfigured() {
+  return !(String(MQTT_BROKER_HOST) == "YOUR_MQTT_BROKER_HERE" ||
+           String(MQTT_BROKER_HOST) == "");
+}
+
+bool smartHomeConfigured() { return mqttConfigured() || webhookConfigured(); }
+
+// Kuyruğa ekler ve hemen döner; sonucu smartHomeWorker raporlar.
+void executeSmartHomeCommand(String action, String device) {
+  if (!smartHomeConfigured()) {
+    Serial.println(
+        "[SmartHome] HATA: MQTT/Webhook ayarlanmamış! (config.h'a bak)");
+    return;
+  }
+  if (smartHomeQueue == NULL)
+    return;
+
+  SmartHomeJob job;
+  action.toCharArray(job.action, sizeof(job.action));
+  device.toCharArray(job.device, sizeof(job.device));
+  job.queuedAt = millis();
+  job.worker = 0;
+
+  if (xQueueSend(smartHomeQueue, &job, 0) != pdTRUE) {
+    smartHomeStats.dropped++;
+    Serial.println("[SmartHome] HATA: Kuyruk dolu, komut atlandı!");
+    return;
+  }
+  smartHomeStats.queued++;
+  // İyimser: gönderim başarısız olursa işçi durumu "bilinmiyor" yapar
+  int a = deviceActionIndex(job.action);
+  if (a >= 0) // 0: turn_on, 1: turn_off
+    deviceStateSet(job.device, a == 0 ? 1 : 0, DEVICE_SOURCE_COMMAND);
+}
+
+// Tek bir webhook isteği (bloklar). HTTP kodu veya negatif hata döner.
+int smartHomeSendWebhook(const SmartHomeJob &job) {
+  // Görev başına kalıcı istemciler: keep-alive varsa TLS tekrar kurulmaz
+  static WiFiClientSecure tlsClients[SMART_HOME_WORKERS];
+  static WiFiClient plainClients[SMART_HOME_WORKERS];
+  WiFiClientSecure &tlsClient = tlsClients[job.worker];
+  WiFiClient &plainClient = plainClients[job.worker];
+  tlsClient.setInsecure();
+
+  // URL oluşturma (Basit string değişimi: {event} -> action_device)
+  // Örnek: action="turn_on", device="light" -> event="turn_on_light"
+  String eventName = String(job.action) + "_" + String(job.device);
+  String url = SMART_HOME_WEBHOOK_URL;
+
+  // URL içinde {event} varsa değiştir (IFTTT tarzı)
+  url.replace("{event}", eventName);
+
+  Serial.println("[SmartHome] İstek: " + url);
+
+  // Home Assistant genelde yerel http, IFTTT https
+  WiFiClient &client =
+      url.startsWith("https") ? (WiFiClient &)tlsClient : plainClient;
+  HTTPClient http;
+  http.setReuse(true);
+  http.setTimeout(SMART_HOME_TIMEOUT_MS);
+
+  // Webhook genelde GET veya POST olur. IFTTT GET kullanabilir.
+  unsigned long t0 = millis();
+  http.begin(client, url);
+  int httpCode = http.GET(); // veya http.POST("");
+  http.end();
+  metricsStage(METRIC_WEBHOOK, t0, httpCode);
+  return httpCode;
+}
+
+// ============================================
+//  MQTT TAŞIYICI (kalıcı yerel bağlantı)
+// ============================================
+WiFiClient mqttNet;
+PubSubClient mqtt(mqttNet);
+SemaphoreHandle_t mqttLock = NULL; // PubSubClient görevler arası güvenli değil
+
+bool mqttEnsureConnected() {
+  static unsigned long lastAttempt = 0;
+  static bool attempted = false;
+  if (mqtt.connected())
+    return true;
+  if (WiFi.status() != WL_CONNECTED)
+    return false;
+  if (attempted && millis() - lastAttempt < MQTT_RECONNECT_MS)
+    return false;
+  attempted = true;
+  lastAttempt = millis();
+
+  String clientId = "alex-" + WiFi.macAddress();
+  bool ok = (String(MQTT_USER) == "")
+                ? mqtt.connect(clientId.c_str())
+                : mqtt.connect(clientId.c_str(), MQTT_USER, MQTT_PASSWORD);
+  if (ok) {
+    metricInc(metrics.mqttConnects);
+    Serial.printf("[MQTT] Bağlandı: %s:%d\n", MQTT_BROKER_HOST,
+                  MQTT_BROKER_PORT);
+    if (strlen(MQTT_STATE_SUFFIX) > 0) {
+      // Oturum temiz açılır; her bağlanmada yeniden abone ol
+      String topic = String(MQTT_TOPIC_PREFIX) + "+" + MQTT_STATE_SUFFIX;
+      mqtt.subscribe(topic.c_str());
+    }
+  }
+  else {
+    Serial.printf("[MQTT] Bağlanamadı, durum: %d\n", mqtt.state());
+  }
+  return ok;
+}
+
+// <önek><cihaz><sonek> konusundan durum: "ON"/"OFF", "on"/"off", "1"/"0".
+// mqtt.loop() içinden (akıllı ev işçisi 0, kilit tutulurken) çağrılır.
+void deviceStateMqtt(char *topic, uint8_t *payload, unsigned int length) {
+  String t = topic;
+  size_t prefix = strlen(MQTT_TOPIC_PREFIX);
+  size_t suffix = strlen(MQTT_STATE_SUFFIX);
+  if (t.length() <= prefix + suffix)
+    return;
+  String id = t.substring(prefix, t.length() - suffix);
+  char value[8];
+  size_t n = min((size_t)length, sizeof(value) - 1);
+  memcpy(value, payload, n);
+  value[n] = '\0';
+  int8_t on = -1;
+  if (strcasecmp(value, "on") == 0 || strcmp(value, "1") == 0)
+    on = 1;
+  else if (strcasecmp(value, "off") == 0 || strcmp(value, "0") == 0)
+    on = 0;
+  deviceStateSet(id.c_str(), on, DEVICE_SOURCE_HA);
+}
+
+bool mqttAvailable() {
+  if (!mqttConfigured())
+    return false;
+  xSemaphoreTake(mqttLock, portMAX_DELAY);
+  bool ok = mqttEnsureConnected();
+  xSemaphoreGive(mqttLock);
+  return ok;
+}
+
+int mqttSend(const SmartHomeJob &job) {
+  String topic = String(MQTT_TOPIC_PREFIX) + job.device + "/set";
+  Serial.println("[SmartHome] MQTT: " + topic + " <- " + job.action);
+  xSemaphoreTake(mqttLock, portMAX_DELAY);
+  // QoS 0: açık sokete tek bir PUBLISH paketi yazılır
+  bool ok = mqtt.publish(topic.c_str(), job.action);
+  if (!ok)
+    mqttNet.stop(); // Yarım kalmış soketi kapat, sonra yeniden bağlan
+  xSemaphoreGive(mqttLock);
+  return ok ? 200 : -1;
+}
+
+// Ana döngüyü bloklamadan keep-alive ve yeniden bağlanma
+void mqttService() {
+  if (!mqttConfigured())
+    return;
+  xSemaphoreTake(mqttLock, portMAX_DELAY);
+  if (mqttEnsureConnected())
+    mqtt.loop();
+  xSemaphoreGive(mqttLock);
+}
+
+void mqttInit() {
+  mqttLock = xSemaphoreCreateMutex();
+  if (!mqttConfigured())
+    return;
+  mqtt.setServer(MQTT_BROKER_HOST, MQTT_BROKER_PORT);
+  mqtt.setKeepAlive(30);
+  mqtt.setCallback(deviceStateMqtt);
+  mqttNet.setNoDelay(true); // Küçük paketler Nagle'a takılmasın
+}
+
+SmartHomeTransport smartHomeTransports[] = {
+    {"MQTT", mqttAvailable, mqttSend, 0, 0, 0, 0},
+    {"Webhook", webhookConfigured, smartHomeSendWebhook, 0, 0, 0, 0},
+};
+const int SMART_HOME_TRANSPORT_COUNT =
+    sizeof(smartHomeTransports) / sizeof(smartHomeTransports[0]);
+
+// Taşıyıcıları öncelik sırasıyla dener; ilk başarılı olanda durur.
+int smartHomeDispatch(const SmartHomeJob &job) {
+  int code = -1;
+  for (int i = 0; i < SMART_HOME_TRANSPORT_COUNT; i++) {
+    SmartHomeTransport &t = smartHomeTransports[i];
+    if (!t.available())
+      continue;
+
+    unsigned long t0 = micros();
+    code = t.send(job);
+    t.lastUs = micros() - t0;
+    if (t.lastUs > t.maxUs)
+      t.maxUs = t.lastUs;
+
+    if (code >= 200 && code < 400) {
+      t.sent++;
+      Serial.printf("[SmartHome] %s ile gönderildi: %.1f ms\n", t.name,
+                    t.lastUs / 1000.0f);
+      return code;
+    }
+    t.failed++;
+    if (code >= 400 && code < 500)
+      return code; // Kalıcı hata, yedeğe geçmenin anlamı yok
+    Serial.printf("[SmartHome] %s başarısız (%d), yedeğe geçiliyor.\n",
+                  t.name, code);
+  }
+  return code;
+}
+
+void smartHomeWorker(void *arg) {
+  uint8_t id = (uint8_t)(uintptr_t)arg;
+  SmartHomeJob job;
+  for (;;) {
+    if (id == 0)
+      mqttService(); // Keep-alive tek görevden yeterli
+    if (xQueueReceive(smartHomeQueue, &job,
+                      pdMS_TO_TICKS(MQTT_LOOP_INTERVAL_MS)) != pdTRUE)
+      continue;
+    job.worker = id;
+
+    int httpCode = 0;
+    unsigned long backoff = SMART_HOME_BACKOFF_MS;
+    for (int attempt = 1; attempt <= SMART_HOME_MAX_ATTEMPTS; attempt++) {
+      httpCode = smartHomeDispatch(job);
+      // 4xx tekrar denemekle düzelmez; sadece ağ hatası ve 5xx'te dene
+      if (httpCode > 0 && httpCode < 500)
+        break;
+      if (attempt == SMART_HOME_MAX_ATTEMPTS)
+        break;
+      Serial.printf("[SmartHome] Deneme %d başarısız (%d), %lu ms sonra "
+                    "tekrar...\n",
+                    attempt, httpCode, backoff);
+      smartHomeStats.retries++;
+      vTaskDelay(pdMS_TO_TICKS(backoff));
+      backoff *= 2;
+    }
+
+    smartHomeStats.lastCode = httpCode;
+    smartHomeStats.lastLatencyMs = millis() - job.queuedAt;
+    if (httpCode >= 200 && httpCode < 400) {
+      smartHomeStats.ok++;
+      Serial.printf("[SmartHome] Başarılı! Kod: %d (%lu ms)\n", httpCode,
+                    smartHomeStats.lastLatencyMs);
+    } else {
+      smartHomeStats.failed++;
+      deviceStateSet(job.device, -1, DEVICE_SOURCE_COMMAND);
+      if (httpCode > 0)
+        Serial.printf("[SmartHome] Hata! Kod: %d\n", httpCode);
+      else
+        Serial.printf("[SmartHome] Hata: %s\n",
+                      HTTPClient::errorToString(httpCode).c_str());
+    }
+  }
+}
+
+// ============================================
+//  CİHAZ KAYDI (NVS)
+// ============================================
+const SmartDevice *deviceFind(const char *id) {
+  for (int i = 0; i < deviceCount; i++)
+    if (strcmp(devices[i].id, id) == 0)
+      return &devices[i];
+  return NULL;
+}
+
+int deviceActionIndex(const char *action) {
+  for (int i = 0; i < DEVICE_ACTION_COUNT; i++)
+    if (strcmp(DEVICE_ACTION_NAMES[i], action) == 0)
+      return i;
+  return -1;
+}
+
+// Gemini metin döndürmezse: "Salon ışığı açılıyor."
+String deviceConfirmation(const GeminiReply &reply) {
+  if (reply.actionCount != 1)
+    return "Tamam, hallediyorum.";
+  const SmartDevice *d = deviceFind(reply.actions[0].device);
+  int a = deviceActionIndex(reply.actions[0].cmd);
+  if (!d || a < 0)
+    return "Tamam.";
+  return String(d->name) + " " + DEVICE_ACTION_VERBS[a] + ".";
+}
+
+// "kimlik=Ad;kimlik=Ad" -> kayıt (tüm eylemler desteklenir)
+void deviceParseList(const String &list) {
+  deviceCount = 0;
+  int start = 0;
+  while (start < (int)list.length() && deviceCount < DEVICE_MAX) {
+    int end = list.indexOf(';', start);
+    if (end < 0)
+      end = list.length();
+    String entry = list.substring(start, end);
+    start = end + 1;
+    int eq = entry.indexOf('=');
+    if (eq <= 0)
+      continue;
+    String id = entry.substring(0, eq);
+    String name = entry.substring(eq + 1);
+    id.trim();
+    name.trim();
+    SmartDevice &d = devices[deviceCount++];
+    id.toCharArray(d.id, sizeof(d.id));
+    name.toCharArray(d.name, sizeof(d.name));
+    d.actions = (1 << DEVICE_ACTION_COUNT) - 1;
+  }
+}
+
+// set_device: cihaz ve eylem enum'la sınırlı, serbest metin JSON yok
+void geminiDeclareDevices(JsonObject root) {
+  JsonObject fn = root.createNestedArray("tools")
+                      .createNestedObject()
+                      .createNestedArray("functionDeclarations")
+                      .createNestedObject();
+  fn["name"] = "set_device";
+  fn["description"] = "Akilli ev cihazini acar ya da kapatir";
+  JsonObject params = fn.createNestedObject("parameters");
+  params["type"] = "OBJECT";
+  JsonObject props = params.createNestedObject("properties");
+
+  JsonObject device = props.createNestedObject("device");
+  device["type"] = "STRING";
+  JsonArray ids = device.createNestedArray("enum");
+  String names = "Cihaz adlari: ";
+  for (int i = 0; i < deviceCount; i++) {
+    ids.add(devices[i].id);
+    names += String(devices[i].name) + "=" + devices[i].id +
+             (i + 1 < deviceCount ? ", " : "");
+  }
+  device["description"] = names;
+
+  JsonObject action = props.createNestedObject("action");
+  action["type"] = "STRING";
+  JsonArray actions = action.createNestedArray("enum");
+  for (int i = 0; i < DEVICE_ACTION_COUNT; i++)
+    actions.add(DEVICE_ACTION_NAMES[i]);
+
+  JsonArray required = params.createNestedArray("required");
+  required.add("device");
+  required.add("action");
+}
+
+// Sistem talimatı + işlev bildirimi; geminiBody'ye eklenir
+String geminiStaticJson() {
+  DynamicJsonDocument doc(2048 + deviceCount * 160);
+  JsonObject root = doc.to<JsonObject>();
+  root["systemInstruction"]["parts"][0]["text"] =
+      "Sen Alex adinda Turkce konusan yardimci bir sesli asistansin. Kisa ve "
+      "net cevap ver. Kullanici bir cihazi acmak ya da kapatmak isterse "
+      "set_device cagir; birden fazla cihaz icin her birine ayri cagri yap.";
+  if (deviceCount > 0)
+    geminiDeclareDevices(root);
+
+  String out;
+  serializeJson(doc, out);
+  return out.substring(1, out.length() - 1); // Dış süslü parantezler
+}
+
+void deviceSave(int index) {
+  char key[8];
+  snprintf(key, sizeof(key), "d%d", index);
+  preferences.putBytes(key, &devices[index], sizeof(SmartDevice));
+}
+
+void deviceRegistryInit() {
+  // config.h'taki liste değişirse NVS kaydı yeniden doldurulur
+  uint32_t seed =
+      esp_rom_crc32_le(0, (const uint8_t *)SMART_HOME_DEVICES,
+                       strlen(SMART_HOME_DEVICES));
+  preferences.begin("alex-devices", false);
+  deviceCount = 0;
+  if (preferences.getUInt("seed", 0) == seed) {
+    int stored = preferences.getInt("count", 0);
+    for (int i = 0; i < stored && i < DEVICE_MAX; i++) {
+      char key[8];
+      snprintf(key, sizeof(key), "d%d", i);
+      SmartDevice &d = devices[deviceCount];
+      if (preferences.getBytes(key, &d, sizeof(d)) != sizeof(d))
+        continue; // Bozuk / eski sürüm kayıt
+      d.id[sizeof(d.id) - 1] = '\0';
+      d.name[sizeof(d.name) - 1] = '\0';
+      if (d.id[0])
+        deviceCount++;
+    }
+  }
+  if (deviceCount == 0) {
+    deviceParseList(SMART_HOME_DEVICES);
+    for (int i = 0; i < deviceCount; i++)
+      deviceSave(i);
+    preferences.putInt("count", deviceCount);
+    preferences.putUInt("seed", seed);
+  }
+  preferences.end();
+
+  geminiStatic = geminiStaticJson();
+  Serial.printf("[Cihaz] %d cihaz kayıtlı, sabit istek kısmı %u bayt.\n",
+                deviceCount, geminiStatic.length());
+
+  for (int i = 0; i < DEVICE_MAX; i++)
+    deviceStates[i] = {-1, DEVICE_SOURCE_NONE, 0};
+  memset(&phraseCache, 0, sizeof(phraseCache));
+}
+
+// ============================================
+//  CİHAZ DURUM ÖNBELLEĞİ
+// ============================================
+int deviceIndex(const char *id) {
+  const SmartDevice *d = deviceFind(id);
+  return d ? (int)(d - devices) : -1;
+}
+
+// Ana döngüden ve akıllı ev işçilerinden çağrılır; alanlar tek tek atomik
+void deviceStateSet(const char *id, int8_t on, uint8_t source) {
+  int i = deviceIndex(id);
+  if (i < 0)
+    return;
+  deviceStates[i].on = on;
+  deviceStates[i].source = source;
+  deviceStates[i].updatedAt = millis();
+}
+
+// Türkçe küçük harf (UTF-8): I -> ı, İ -> i, Ç Ğ Ö Ş Ü
+String trLower(const String &s) {
+  String out;
+  out.reserve(s.length() + 4);
+  for (int i = 0; i < (int)s.length(); i++) {
+    uint8_t c = s[i];
+    if (c == 'I') {
+      out += "ı";
+    } else if (c >= 'A' && c <= 'Z') {
+      out += (char)(c + 32);
+    } else if ((c == 0xC3 || c == 0xC4 || c == 0xC5) &&
+               i + 1 < (int)s.length()) {
+      uint8_t d = s[++i];
+      if (c == 0xC4 && d == 0xB0) { // İ
+        out += 'i';
+        continue;
+      }
+      if (c == 0xC3 && (d == 0x87 || d == 0x96 || d == 0x9C)) // Ç Ö Ü
+        d += 0x20;
+      else if ((c == 0xC4 || c == 0xC5) && d == 0x9E) // Ğ Ş
+        d += 1;
+      out += (char)c;
+      out += (char)d;
+    } else {
+      out += (char)c;
+    }
+  }
+  return out;
+}
+
+// Soru kalıbı + kayıtlı cihaz adı: cihaz indeksi, değilse -1.
+// Kalıp cümlenin sonunda olmalı: "açık mı kalsın, kapat" bir komuttur.
+// Birden çok ad geçiyorsa en uzunu ("salon ışığı" > "salon").
+int deviceStatusQuery(const String &transcript) {
+  static const char *const QUERY_WORDS[] = {
+      "açık mı",    "açık mi",    "kapalı mı",    "kapalı mi",
+      "yanıyor mu", "ne durumda", "durumu ne",    "durumu nedir"};
+  String text = trLower(transcript);
+  int end = text.length();
+  while (end > 0 && strchr(" ?.!,", text[end - 1]))
+    end--;
+  text.remove(end);
+  bool question = false;
+  for (const char *w : QUERY_WORDS)
+    if (text.endsWith(w))
+      question = true;
+  if (!question)
+    return -1;
+  int best = -1;
+  size_t bestLen = 0;
+  for (int i = 0; i < deviceCount; i++) {
+    String name = trLower(devices[i].name);
+    if (name.length() > bestLen && text.indexOf(name) >= 0) {
+      best = i;
+      bestLen = name.length();
+    }
+  }
+  return best;
+}
+
+String deviceStatePhrase(int index, int8_t on) {
+  String name = devices[index].name;
+  if (on < 0)
+    return name + " durumunu bilmiyorum.";
+  return name + (on ? " açık." : " kapalı.");
+}
+
+// Cevap önbellekteyse hemen kuyruğa; değilse bir kez sentezlenip saklanır
+void deviceAnswerState(int index) {
+  DeviceState st = deviceStates[index];
+  int slot = st.on + 1;
+  Serial.printf("[Cihaz] %s: %s (kaynak: %s, %lu sn önce)\n",
+                devices[index].id,
+                st.on < 0 ? "bilinmiyor" : (st.on ? "açık" : "kapalı"),
+                DEVICE_SOURCE_NAMES[st.source],
+                st.source == DEVICE_SOURCE_NONE
+                    ? 0UL
+                    : (millis() - st.updatedAt) / 1000);
+  phraseCache.answers++;
+  setState(STATE_SPEAKING);
+
+  PhraseCache &pc = phraseCache;
+  if (pc.pcm[index][slot]) {
+    pc.hits++;
+    playbackEnqueue(pc.pcm[index][slot], pc.samples[index][slot], false);
+  } else {
+    pc.misses++;
+    String text = deviceStatePhrase(index, st.on);
+    size_t n = 0;
+    int16_t *pcm =
+        WiFi.status() == WL_CONNECTED ? cloudTtsFetch(text, n) : NULL;
+    if (pcm && pc.bytes + n * sizeof(int16_t) <= PHRASE_CACHE_MAX_BYTES) {
+      pc.pcm[index][slot] = pcm;
+      pc.samples[index][slot] = n;
+      pc.bytes += n * sizeof(int16_t);
+      playbackEnqueue(pcm, n, false);
+    } else if (pcm) {
+      playbackEnqueue(pcm, n, true); // Önbellek dolu, bir kez çal
+    } else {
+      localTextToSpeech(text); // Bağlantı yok: saklanmaz, yerel sentez hızlı
+    }
+  }
+  Serial.printf("[Cihaz] Durum cevabı %lu ms'de kuyrukta (LLM yok).\n",
+                millis() - turn.start);
+}
+
+void smartHomeInit() {
+  deviceRegistryInit();
+  mqttInit();
+  smartHomeQueue = xQueueCreate(SMART_HOME_QUEUE_LEN, sizeof(SmartHomeJob));
+  for (int i = 0; i < SMART_HOME_WORKERS; i++) {
+    char name[16];
+    snprintf(name, sizeof(name), "smart_home%d", i);
+    xTaskCreatePinnedToCore(smartHomeWorker, name, 8192, (void *)(uintptr_t)i,
+                            2, NULL, 0);
+  }
+}
+
+// ============================================
+//  AĞ ISINDIRMA (Warm-up) & DNS ÖNBELLEĞİ
+// ============================================
+bool dnsResolve(NetEndpoint &ep) {
+  if (ep.dnsValid && (long)(millis() - ep.dnsExpiresAt) < 0) {
+    netStats.dnsHits++;
+    return true;
+  }
+  netStats.dnsMisses++;
+  IPAddress ip;
+  if (!WiFi.hostByName(ep.host, ip)) {
+    Serial.printf("[Net] DNS çözülemedi: %s\n", ep.host);
+    ep.dnsValid = false;
+    return false;
+  }
+  ep.ip = ip;
+  ep.dnsExpiresAt = millis() + DNS_CACHE_TTL_MS;
+  ep.dnsValid = true;
+  return true;
+}
+
+// Kilit çağıran tarafından alınmış olmalı
+bool netConnect(NetEndpoint &ep) {
+  if (ep.client.connected())
+    return true;
+  ep.client.stop();
+  if (!dnsResolve(ep))
+    return false;
+  // IP ile bağlan, SNI için sunucu adını ayrıca ver
+  if (ep.client.connect(ep.ip, 443, ep.host, NULL, NULL, NULL) == 1)
+    return true;
+  // Sunucu IP'si değişmiş olabilir: TTL dolmasını beklemeden yeniden çöz
+  ep.dnsValid = false;
+  return false;
+}
+
+void netWarmupTask(void *arg) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    unsigned long t0 = millis();
+    for (int i = 0; i < NET_HOST_COUNT; i++) {
+      NetEndpoint &ep = netEndpoints[i];
+      xSemaphoreTake(ep.lock, portMAX_DELAY);
+      ep.warm = netConnect(ep) ? WARM_READY : WARM_FAILED;
+      xSemaphoreGive(ep.lock);
+    }
+    Serial.printf("[Net] Warm-up bitti: %lu ms\n", millis() - t0);
+  }
+}
+
+void netWarmupInit() {
+  const char *hosts[NET_HOST_COUNT] = {STT_HOST, LLM_HOST, TTS_HOST};
+  for (int i = 0; i < NET_HOST_COUNT; i++) {
+    NetEndpoint &ep = netEndpoints[i];
+    ep.host = hosts[i];
+    ep.dnsValid = false;
+    ep.dnsExpiresAt = 0;
+    ep.lock = xSemaphoreCreateMutex();
+    ep.warm = WARM_IDLE;
+    ep.client.setInsecure();
+    ep.client.setHandshakeTimeout(NET_HANDSHAKE_TIMEOUT_S);
+  }
+  // Ağ işleri core 0'da, ana döngü (ses) core 1'de kalsın
+  xTaskCreatePinnedToCore(netWarmupTask, "net_warmup", NET_WARMUP_STACK, NULL,
+                          1, &netWarmupTaskHandle, 0);
+}
+
+void netWarmupKick() {
+  if (netWarmupTaskHandle == NULL || WiFi.status() != WL_CONNECTED)
+    return;
+  // warm kilit altında yazılır. Kilit meşgulse (warm-up ya da istek sürüyor)
+  // bekleme yok: durumu kilidi tutan taraf zaten güncelleyecek.
+  for (int i = 0; i < NET_HOST_COUNT; i++) {
+    NetEndpoint &ep = netEndpoints[i];
+    if (xSemaphoreTake(ep.lock, 0) != pdTRUE)
+      continue;
+    if (ep.warm != WARM_READY)
+      ep.warm = WARM_BUSY;
+    xSemaphoreGive(ep.lock);
+  }
+  xTaskNotifyGive(netWarmupTaskHandle);
+}
+
+// waitMs içinde kilit alınamazsa NULL (vazgeçilmiş bir hedge denemesi ya da
+// spekülatif istek bağlantıyı hâlâ tutuyor olabilir)
+WiFiClientSecure *netAcquire(NetHost h, uint32_t waitMs) {
+  NetEndpoint &ep = netEndpoints[h];
+  WarmState seen = ep.warm;
+  // Warm-up bu sunucuya bağlanıyorsa kilit, el sıkışma bitene kadar bekletir
+  if (xSemaphoreTake(ep.lock, pdMS_TO_TICKS(waitMs)) != pdTRUE) {
+    netStats.busy++;
+    Serial.printf("[Net] %s bağlantısı %u ms içinde boşalmadı.\n", ep.host,
+                  waitMs);
+    return NULL;
+  }
+
+  if (seen == WARM_READY && ep.client.connected()) {
+    netStats.ready++;
+  } else if (seen == WARM_BUSY && ep.warm == WARM_READY) {
+    netStats.late++;
+  } else {
+    netStats.missed++;
+    netConnect(ep); // Başarısızsa HTTPClient kendisi tekrar dener
+  }
+  ep.warm = WARM_IDLE;
+  return &ep.client;
+}
+
+void netRelease(NetHost h) { xSemaphoreGive(netEndpoints[h].lock); }
+
+void netWarmupReport() {
+  uint32_t total = netStats.ready + netStats.late + netStats.missed;
+  if (total == 0)
+    return;
+  Serial.printf("[Net] Warm-up: hazır %u, geç %u, yok %u (%%%u isabet), "
+                "meşgul %u | DNS önbellek: %u isabet, %u sorgu\n",
+                netStats.ready, netStats.late, netStats.missed,
+                (netStats.ready * 100) / total, netStats.busy,
+                netStats.dnsHits, netStats.dnsMisses);
+}
+
+// ============================================
+//  YARDIMCI FONKSİYONLAR
+// ============================================
+const char *const STATE_NAMES[] = {"IDLE", "LISTENING", "THINKING",
+                                   "SPEAKING"};
+
+void setState(SystemState s) {
+  SystemState from = currentState;
+  currentState = s;
+  Serial.printf("\n[DURUM] >>> %s\n", STATE_NAMES[s]);
+  memSample(from, s);
+#ifdef USE_LOW_POWER_IDLE
+  if (s == STATE_IDLE)
+    powerIdleEnter();
+  else
+    powerIdleExit(); // Tetiklemede powerIdleFlush zaten çıkmıştır
+#endif
+  if (s == STATE_IDLE || s == STATE_LISTENING) {
+    lastSoundTime = millis();
+    soundDetected = false;
+  }
+#ifdef USE_EARCONS
+  if (s == STATE_LISTENING) {
+    // RMS tetiğinde kullanıcı konuşmaya başlamış, ön kayıt da eklenmiş:
+    // uyanma sesi kayda karışır, blok atmak da kayıtta delik açar. Sadece
+    // uyanma kelimesi ve takip girişinde çalınır.
+    if (!wakeChimeSkip) {
+      earconPlay(&EARCON_WAKE);
+      if (followUpActive) { // Takipte kayıt konuşma başlayınca açılır
+        followUpIgnoreUntil = millis() +
+                              EARCON_WAKE.samples * 1000UL / SAMPLE_RATE +
+                              PLAYBACK_TAIL_MS;
+        followUpDeadline = followUpIgnoreUntil + FOLLOW_UP_WINDOW_MS;
+      }
+    }
+    wakeChimeSkip = false;
+  } else if (s == STATE_THINKING) {
+#ifdef EARCON_THINKING_LOOP
+    earconPlay(&EARCON_THINK, &EARCON_PULSE);
+#else
+    earconPlay(&EARCON_THINK);
+#endif
+  } else if (s == STATE_IDLE) {
+    earconStop();
+  }
+#endif
+  if (s == STATE_LISTENING) {
+    netWarmupKick(); // Kullanıcı konuşurken soketleri hazırla
+  } else if (s == STATE_IDLE) {
+    turn.active = false;
+    netWarmupReport();
+    audioHealthReport();
+    playbackReport();
+    frontEndReport();
+    memReport();
+  }
+}
+
+// ============================================
+//  I2S SÜRÜCÜ KURULUMU & DMA SAĞLIĞI
+// ============================================
+bool i2sCheck(esp_err_t err, const char *what) {
+  if (err == ESP_OK)
+    return true;
+  Serial.printf("[I2S] HATA: %s: %s\n", what, esp_err_to_name(err));
+  return false;
+}
+
+bool i2sInstall(AudioPortHealth &h) {
+  bool isMic = (h.port == MIC_PORT);
+  i2s_config_t cfg =
+      isMic ? MicAudio::i2sConfig(h.profile.dmaBufCount, h.profile.dmaBufLen)
+            : SpeakerAudio::i2sConfig(h.profile.dmaBufCount,
+                                      h.profile.dmaBufLen);
+  i2s_pin_config_t pins = isMic ? MicAudio::pins() : SpeakerAudio::pins();
+
+  if (!i2sCheck(i2s_driver_install(h.port, &cfg, I2S_EVENT_QUEUE_LEN,
+                                   &h.events),
+                "driver_install"))
+    return false;
+  if (!i2sCheck(i2s_set_pin(h.port, &pins), "set_pin"))
+    return false;
+  i2sCheck(i2s_zero_dma_buffer(h.port), "zero_dma_buffer");
+  return true;
+}
+
+// Her port için olay kuyruğunu dinler ve taşma/boşalma sayar
+void i2sEventTask(void *arg) {
+  AudioPortHealth &h = *(AudioPortHealth *)arg;
+  i2s_event_t ev;
+  for (;;) {
+    if (h.events == NULL) { // Sürücü kurulamadı
+      vTaskDelay(pdMS_TO_TICKS(1000));
+      continue;
+    }
+    if (xQueueReceive(h.events, &ev, pdMS_TO_TICKS(50)) != pdTRUE)
+      continue;
+
+    switch (ev.type) {
+    case I2S_EVENT_RX_Q_OVF:
+      // THINKING/SPEAKING'de mikrofon bilerek okunmuyor, sayma
+      if (currentState == STATE_IDLE || currentState == STATE_LISTENING)
+        h.overflows++;
+      break;
+    case I2S_EVENT_TX_Q_OVF:
+      if (playbackActive)
+        h.underruns++;
+      break;
+    case I2S_EVENT_DMA_ERROR:
+      h.dmaErrors++;
+      break;
+    default:
+      break;
+    }
   }
+}
 
-  http.end();
-  return response;
+// DMA halkasının tutabileceği en fazla ses (ms)
+float audioPortDelayMs(const AudioPortHealth &h) {
+  return (float)(h.profile.dmaBufCount * h.profile.dmaBufLen) * 1000.0f /
+         SAMPLE_RATE;
+}
+
+// Mikrofon DMA + okuma bloğu + hoparlör DMA: sesin cihazda bekleyebileceği süre
+float audioBufferingDelayMs() {
+  return audioPortDelayMs(micHealth) +
+         (float)BUFFER_LENGTH * 1000.0f / SAMPLE_RATE +
+         audioPortDelayMs(spkHealth);
+}
+
+void audioHealthReport() {
+  uint32_t total = micHealth.overflows + micHealth.dmaErrors +
+                   spkHealth.underruns + spkHealth.dmaErrors;
+  uint32_t last = micHealth.reportedTotal + spkHealth.reportedTotal;
+  if (total == last)
+    return;
+  micHealth.reportedTotal = micHealth.overflows + micHealth.dmaErrors;
+  spkHealth.reportedTotal = spkHealth.underruns + spkHealth.dmaErrors;
+  Serial.printf("[I2S] RX taşma: %u, TX boşalma: %u, DMA hata: %u | "
+                "tamponlama gecikmesi: %.0f ms\n",
+                micHealth.overflows, spkHealth.underruns,
+                micHealth.dmaErrors + spkHealth.dmaErrors,
+                audioBufferingDelayMs());
 }
 
+void playbackReport() {
+  if (playbackStats.underruns == playbackStats.reportedUnderruns)
+    return;
+  playbackStats.reportedUnderruns = playbackStats.underruns;
+  Serial.printf("[SPK] Tampon: %u, durdurulan: %u, underrun: %u "
+                "(sessizlik dolgusu: %u blok)\n",
+                playbackStats.buffers, playbackStats.stopped,
+                playbackStats.underruns, playbackStats.silenceBlocks);
+}
+
+#ifdef USE_WAKE_MODEL_PARTITION
 // ============================================
-//  TEXT TO SPEECH — Stream ile PSRAM'a
+//  UYANMA MODELİ — bölüm + ağdan güncelleme
 // ============================================
-void textToSpeech(const String &text) {
-  Serial.println("[TTS] Sentezleniyor...");
+void wakeModelLog() {
+  if (wakeModel.data)
+    Serial.printf("[Model] Yuva %d: '%s' v%u, %u bayt (flash'a eşli)\n",
+                  wakeModel.slot, wakeModel.header.name,
+                  wakeModel.header.version, (unsigned)wakeModel.size);
+  else
+    Serial.println("[Model] Geçerli model yok.");
+}
 
-  String body = "{\"input\":{\"text\":\"" + text +
-                "\"},"
-                "\"voice\":{\"languageCode\":\"tr-TR\","
-                "\"name\":\"tr-TR-Wavenet-A\"},"
-                "\"audioConfig\":{\"audioEncoding\":\"LINEAR16\","
-                "\"sampleRateHertz\":" +
-                String(SAMPLE_RATE) + "}}";
+// "?version=3&name=hey_alex" içinden bir parametre
+String wakeModelQueryParam(const String &request, const char *key) {
+  String k = String(key) + "=";
+  int start = request.indexOf(k);
+  if (start < 0)
+    return "";
+  start += k.length();
+  int end = start;
+  while (end < (int)request.length() && request[end] != '&' &&
+         request[end] != ' ')
+    end++;
+  return request.substring(start, end);
+}
 
-  WiFiClientSecure client;
-  client.setInsecure();
-  HTTPClient http;
+// Sabit süreli karşılaştırma: cevap süresinden parola harf harf bulunamasın
+bool wakeModelTokenOk(const String &token) {
+  const char *want = WAKE_MODEL_TOKEN;
+  size_t n = strlen(want);
+  if (n == 0)
+    return false; // Parolasız yükleme yok
+  uint8_t diff = token.length() != n;
+  for (size_t i = 0; i < n; i++)
+    diff |= (uint8_t)(i < token.length() ? token[i] : 0) ^ (uint8_t)want[i];
+  return diff == 0;
+}
 
-  String url = String(TTS_URL_BASE) + String(googleApiKey);
-  http.begin(client, url);
-  http.addHeader("Content-Type", "application/json");
-  http.setTimeout(15000);
+// Gövdeyi eşli olmayan yuvaya akıtır; HTTP kodu döner
+int wakeModelReceive(WiFiClient &client, const String &request, size_t length,
+                     const String &token, String &msg) {
+  static uint8_t chunk[WAKE_MODEL_CHUNK];
+  if (!wakeModelTokenOk(token)) {
+    msg = "X-Token gecersiz";
+    return 403;
+  }
+  if (wakeModelReloadPending) {
+    msg = "Onceki model henuz etkinlesmedi";
+    return 409;
+  }
+  uint32_t version = wakeModelQueryParam(request, "version").toInt();
+  String name = wakeModelQueryParam(request, "name");
+  if (name.isEmpty())
+    name = "model";
 
-  int code = http.POST(body);
-  if (code != 200) {
-    Serial.printf("[TTS] HTTP Hata: %d\n", code);
-    http.end();
-    return;
+  unsigned long t0 = millis();
+  WakeModelWriter w;
+  esp_err_t err =
+      wakeModelWriteBegin(wakeModel, w, length, version, name.c_str());
+  if (err == ESP_ERR_INVALID_VERSION) {
+    msg = "Surum etkin modelden (v" + String(wakeModel.header.version) +
+          ") buyuk olmali";
+    return 409;
+  }
+  if (err == ESP_ERR_INVALID_SIZE) {
+    msg = "Boyut 0 ya da yuvadan (" + String(wakeModel.slotSize) +
+          " bayt) buyuk";
+    return 413;
   }
+  if (err != ESP_OK) {
+    msg = String("Silme hatasi: ") + esp_err_to_name(err);
+    return 500;
+  }
+  while (w.written < length) {
+    size_t n = client.readBytes(
+        chunk, min((size_t)WAKE_MODEL_CHUNK, length - w.written));
+    if (n == 0) {
+      msg = "Govde eksik geldi";
+      return 400;
+    }
+    err = wakeModelWrite(wakeModel, w, chunk, n);
+    if (err != ESP_OK) {
+      msg = String("Yazma hatasi: ") + esp_err_to_name(err);
+      return 500;
+    }
+  }
+  err = wakeModelWriteEnd(wakeModel, w);
+  if (err != ESP_OK) {
+    msg = String("Baslik yazilamadi: ") + esp_err_to_name(err);
+    return 500;
+  }
+  Serial.printf("[Model] Yuva %d'e yazıldı: '%s' v%u, %u bayt, %lu ms\n",
+                w.slot, w.header.name, version, (unsigned)length,
+                millis() - t0);
+  wakeModelReloadPending = true;
+  msg = "Yuva " + String(w.slot) + ", v" + String(version) +
+        " yazildi; bir sonraki IDLE'da etkin";
+  return 200;
+}
 
-  WiFiClient *stream = http.getStreamPtr();
-  const String token = "\"audioContent\":\"";
-  String searchBuf = "";
-  bool found = false;
-  unsigned long timeout = millis() + 10000;
-
-  while (millis() < timeout) {
-    if (stream->available()) {
-      char c = stream->read();
-      searchBuf += c;
-      if (searchBuf.length() > (unsigned)token.length())
-        searchBuf.remove(0, 1);
-      if (searchBuf == token) {
-        found = true;
+void wakeModelServerTask(void *arg) {
+  WiFiServer server(WAKE_MODEL_PORT);
+  server.begin();
+  for (;;) {
+    WiFiClient client = server.available();
+    if (!client) {
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
+    }
+    client.setTimeout(5); // sn
+    String request = client.readStringUntil('\n');
+    size_t length = 0;
+    String token;
+    for (int i = 0; i < 32 && client.connected(); i++) {
+      String line = client.readStringUntil('\n');
+      if (line.length() <= 1)
         break;
-      }
+      int colon = line.indexOf(':');
+      if (colon < 0)
+        continue;
+      String key = line.substring(0, colon);
+      key.toLowerCase();
+      String value = line.substring(colon + 1);
+      value.trim();
+      if (key == "content-length")
+        length = value.toInt();
+      else if (key == "x-token")
+        token = value;
     }
+
+    int code = 404;
+    String body = "";
+    if (request.startsWith("PUT /wake-model")) {
+      code = wakeModelReceive(client, request, length, token, body);
+    } else if (request.startsWith("GET /wake-model")) {
+      code = 200;
+      body = "{\"slot\":" + String(wakeModel.slot) +
+             ",\"version\":" + String(wakeModel.header.version) +
+             ",\"name\":\"" + String(wakeModel.data ? wakeModel.header.name
+                                                    : "") +
+             "\",\"size\":" + String(wakeModel.size) +
+             ",\"slotSize\":" + String(wakeModel.slotSize) +
+             ",\"pending\":" + (wakeModelReloadPending ? "true" : "false") +
+             "}";
+    }
+    client.printf("HTTP/1.1 %d %s\r\nConnection: close\r\n\r\n%s\n", code,
+                  code == 200 ? "OK" : "Error", body.c_str());
+    client.stop();
   }
+}
 
-  if (!found) {
-    Serial.println("[TTS] audioContent bulunamadı!");
-    http.end();
+void wakeModelInit() {
+  unsigned long t0 = micros();
+  bool ok = wakeModelOpen(wakeModel);
+  if (!wakeModel.part) {
+    Serial.println("[Model] 'wakemodel' bölümü yok (partitions.csv).");
     return;
   }
-
-  const size_t maxB64 = 300 * 1024;
-  char *b64Buf = (char *)ps_malloc(maxB64);
-  if (!b64Buf) {
-    Serial.println("[TTS] HATA: PSRAM yetersiz!");
-    http.end();
+  Serial.printf("[Model] Eşleme + CRC: %lu us\n", micros() - t0);
+  wakeModelLog();
+#ifndef USE_WAKE_WORD
+  (void)ok;
+  Serial.println("[Model] USE_WAKE_WORD kapalı, yükleme sunucusu yok.");
+#else
+  // Yerel ağa açık bir yazma ucu: parola yoksa hiç dinlenmez
+  if (strlen(WAKE_MODEL_TOKEN) == 0) {
+    Serial.println("[Model] WAKE_MODEL_TOKEN boş, yükleme sunucusu kapalı.");
     return;
   }
+  if (!ok)
+    Serial.printf("[Model] Yüklemek için: curl -T model.ppn -H \"X-Token: "
+                  "...\" \"http://%s:%d/wake-model?version=1\"\n",
+                  WiFi.localIP().toString().c_str(), WAKE_MODEL_PORT);
+  xTaskCreatePinnedToCore(wakeModelServerTask, "wake_model", 4096, NULL, 1,
+                          NULL, 0);
+#endif
+}
 
-  size_t b64Pos = 0;
-  timeout = millis() + 15000;
-  while (millis() < timeout && b64Pos < maxB64 - 1) {
-    if (stream->available()) {
-      char c = stream->read();
-      if (c == '"')
-        break;
-      b64Buf[b64Pos++] = c;
-    }
+// Ana döngüden, IDLE'da: motor eski eşlemeyi bırakır, yenisi açılır
+void wakeModelReload() {
+#ifdef USE_WAKE_WORD
+  if (porcupine) {
+    pv_porcupine_delete(porcupine);
+    porcupine = NULL;
   }
-  b64Buf[b64Pos] = '\0';
-  Serial.printf("[TTS] Base64 alındı: %d KB\n", b64Pos / 1024);
-  http.end();
+#endif
+  wakeModelClose(wakeModel);
+  wakeModelOpen(wakeModel);
+  wakeModelLog();
+  wakeWordInit();
+  wakeModelReloadPending = false;
+}
+#endif
 
-  size_t maxDecoded = (b64Pos * 3) / 4;
-  uint8_t *audioBuf = (uint8_t *)ps_malloc(maxDecoded);
-  if (!audioBuf) {
-    Serial.println("[TTS] HATA: Decode için PSRAM yetersiz!");
-    free(b64Buf);
+#ifdef USE_LOW_POWER_IDLE
+// ============================================
+//  DÜŞÜK GÜÇLÜ BEKLEME
+// ============================================
+// ESP32-S3'te ULP, I2S'i okuyamaz; bu yüzden algılama ana çekirdekte
+// kalır ama ucuzlar. I2S saati CPU saatinden bağımsız (PLL 160 MHz), DMA
+// saat değişiminde örnek kaçırmaz.
+void powerIdleInit() {
+  powerIdle.preRoll = (int32_t *)memTrackAlloc(
+      PRE_ROLL_SAMPLES * sizeof(int32_t), true, "preroll");
+  if (!powerIdle.preRoll)
+    Serial.println("[Güç] Ön kayıt halkası ayrılamadı, tetik öncesi ses yok.");
+  Serial.printf("[Güç] Bekleme: %d MHz + modem uykusu, ön kayıt %d ms\n",
+                IDLE_CPU_MHZ, PRE_ROLL_MS);
+}
+
+void powerIdleEnter() {
+  if (powerIdle.active)
+    return;
+  setCpuFrequencyMhz(IDLE_CPU_MHZ);
+  WiFi.setSleep(WIFI_PS_MAX_MODEM); // DTIM aralığında uyanır
+  powerIdle.preRollHead = 0;
+  powerIdle.preRollFill = 0;
+  powerIdle.blocks = 0;
+  powerIdle.enteredAt = millis();
+  powerIdle.active = true;
+}
+
+void powerIdleExit() {
+  if (!powerIdle.active)
+    return;
+  unsigned long t0 = micros();
+  setCpuFrequencyMhz(ACTIVE_CPU_MHZ);
+  WiFi.setSleep(WIFI_PS_NONE); // Yükleme/indirme sırasında gecikme yok
+  powerIdle.clockUsLast = micros() - t0;
+  powerIdle.idleMs += millis() - powerIdle.enteredAt;
+  powerIdle.active = false;
+}
+
+// Ham örnekleri halkaya yazar (sadece kopya, dönüşüm yok)
+void powerIdlePush(const int32_t *raw, int n) {
+  if (!powerIdle.preRoll)
     return;
+  for (int i = 0; i < n; i++) {
+    powerIdle.preRoll[powerIdle.preRollHead] = raw[i];
+    if (++powerIdle.preRollHead == PRE_ROLL_SAMPLES)
+      powerIdle.preRollHead = 0;
   }
+  powerIdle.preRollFill =
+      min(powerIdle.preRollFill + (size_t)n, (size_t)PRE_ROLL_SAMPLES);
+}
 
-  size_t actualLen = base64Decode(b64Buf, b64Pos, audioBuf);
-  free(b64Buf);
+// Tetiklemede: tam hıza çık, halkayı (tetik bloğu dahil) ön işlemeden
+// geçirip kayda ekle. triggerUs: tetik bloğunun okunduğu an.
+void powerIdleFlush(unsigned long triggerUs) {
+  if (!powerIdle.active)
+    return;
+  powerIdleExit();
+#ifdef USE_STREAMING_STT
+  sttStreamBegin(); // Kayıt boş değil, LISTENING başlatamaz
+#endif
+  size_t n = powerIdle.preRollFill;
+  size_t pos = (powerIdle.preRollHead + PRE_ROLL_SAMPLES - n) % PRE_ROLL_SAMPLES;
+  // Filtreler beklemede sadece ara sıra (ve halkanın ortasına kadar) beslendi;
+  // halkanın başından yeniden işlerken eski durum tık üretir. Sıfırla (AGC
+  // kazancı ve gürültü profili korunur).
+  if (n > 0) {
+    afeResetFilters(frontEnd, powerIdle.preRoll[pos]);
+#ifdef USE_NOISE_SUPPRESSION
+    nsResetStream(noiseSuppressor);
+#endif
+  }
+  while (n > 0) {
+    int block = min(n, (size_t)BUFFER_LENGTH);
+    block = min(block, (int)(PRE_ROLL_SAMPLES - pos)); // Halka sonu
+    afeProcess(frontEnd, powerIdle.preRoll + pos, frontEndBuffer, block);
+#ifdef USE_NOISE_SUPPRESSION
+    nsProcess(noiseSuppressor, frontEndBuffer, frontEndBuffer, block, false,
+              afeGain(frontEnd));
+#endif
+    recordAppend(frontEndBuffer, block);
+    pos = (pos + block) % PRE_ROLL_SAMPLES;
+    n -= block;
+  }
+  lastSoundTime = millis();
+  powerIdle.wakes++;
+  powerIdle.wakeUsLast = micros() - triggerUs;
+  if (powerIdle.wakeUsLast > powerIdle.wakeUsMax)
+    powerIdle.wakeUsMax = powerIdle.wakeUsLast;
+  Serial.printf("[Güç] Uyanma: %lu us (saat+Wi-Fi %lu us), ön kayıt %u ms\n",
+                (unsigned long)powerIdle.wakeUsLast,
+                (unsigned long)powerIdle.clockUsLast,
+                (unsigned)(powerIdle.preRollFill * 1000 / SAMPLE_RATE));
+}
 
-  Serial.printf("[TTS] Ses hazır: %.1f sn\n",
-                (float)(actualLen / sizeof(int16_t)) / SAMPLE_RATE);
+// Bekleme süresi oranı (şu anki bekleme dahil)
+float powerIdleRatio() {
+  uint64_t idle = powerIdle.idleMs;
+  if (powerIdle.active)
+    idle += millis() - powerIdle.enteredAt;
+  return millis() > 0 ? (float)idle / millis() : 0.0f;
+}
 
-  playAudio((int16_t *)audioBuf, actualLen / sizeof(int16_t));
-  free(audioBuf);
+// Bekleme bloklarında ana döngünün CPU payı (IDLE_CPU_MHZ'de)
+float powerIdleLoad() {
+  uint64_t idle = powerIdle.idleMs;
+  if (powerIdle.active)
+    idle += millis() - powerIdle.enteredAt;
+  if (idle == 0)
+    return 0.0f;
+  return (float)powerIdle.busyCycles / ((float)idle * IDLE_CPU_MHZ * 1000.0f);
 }
+#endif
 
 // ============================================
-//  SES ÇALMA
+//  TUR SÜRE BÜTÇESİ
 // ============================================
-void playAudio(int16_t *audioData, size_t sampleCount) {
-  Serial.printf("[SPK] Çalınıyor: %.1f sn\n", (float)sampleCount / SAMPLE_RATE);
-  size_t offset = 0;
-  while (offset < sampleCount) {
-    size_t toWrite = min((size_t)BUFFER_LENGTH, sampleCount - offset);
-    size_t written = 0;
-    i2s_write(SPK_PORT, audioData + offset, toWrite * sizeof(int16_t), &written,
-              portMAX_DELAY);
-    if (written == 0)
-      break;
-    offset += written / sizeof(int16_t);
-  }
+// Kayıt bitince çağrılır; sınır ilk sesin kuyruğa girmesine kadar geçerli
+void turnBegin() {
+  turn.start = millis();
+  turn.deadline = turn.start + TURN_DEADLINE_MS;
+  turn.active = true;
+  turn.turns++;
+}
+
+// Kalan sürenin, bu ve sonraki aşamaların ağırlığına göre bu aşamaya düşen
+// payı. Tur dışında (takip parçaları vb.) eski sabit süreler geçerli.
+uint32_t turnStageBudget(MetricStage stage) {
+  static const uint8_t weights[] = {TURN_WEIGHT_STT, TURN_WEIGHT_LLM,
+                                    TURN_WEIGHT_TTS};
+  if (!turn.active)
+    return stage == METRIC_LLM ? 20000 : 15000;
+  long remaining = (long)(turn.deadline - millis());
+  if (remaining <= 0)
+    return 0;
+  uint32_t total = 0;
+  for (int i = stage; i <= METRIC_TTS; i++)
+    total += weights[i];
+  return (uint32_t)remaining * weights[stage] / total;
+}
+
+bool turnExpired() {
+  return turn.active && (long)(turn.deadline - millis()) < TURN_MIN_STAGE_MS;
+}
+
+void turnFirstAudio() {
+  turn.active = false;
+  unsigned long ms = millis() - turn.start;
+  if (ms > turn.worstMs)
+    turn.worstMs = ms;
+  Serial.printf("[Tur] İlk ses: %lu ms (sınır %d, en kötü %lu) | aşılan "
+                "%u/%u, hedge %u (kazanan %u)\n",
+                ms, TURN_DEADLINE_MS, turn.worstMs, turn.expired, turn.turns,
+                turn.hedged, turn.hedgeWins);
+}
+
+// Bütçe bittiğinde kullanıcı sessizlikle baş başa kalmasın: yerel sentez
+void turnApology() {
+  turn.expired++;
+  Serial.printf("[Tur] Süre doldu (%lu ms), özür okunuyor.\n",
+                millis() - turn.start);
+  localTextToSpeech(TURN_APOLOGY);
 }
 
 // ============================================
-//  WI-FI & AYARLAR (WiFiManager)
+//  METRİKLER
 // ============================================
-void wifi_connect() {
-  WiFi.mode(WIFI_STA);
+// İşlem hattından çağrılır: kilit yok, sadece atomik artırmalar
+void metricsStage(MetricStage stage, unsigned long startMs, int httpCode) {
+#ifdef USE_METRICS
+  metricObserve(metrics.latency[stage], millis() - startMs);
+  metricHttpCode(metrics.httpCodes[stage], httpCode);
+#endif
+}
 
-  // 1. Ayarları Oku
-  preferences.begin("alex-config", false);
-  String gKey = preferences.getString("g_key", "");
-  String pKey = preferences.getString("p_key", "");
-  String wUrl = preferences.getString("w_url", "");
+void metricsWake() {
+#ifdef USE_METRICS
+  metricInc(metrics.wakeTriggers);
+  uint32_t minute = millis() / 60000;
+  int slot = minute % 60;
+  if (metrics.wakeMinute[slot] != minute) {
+    metrics.wakeMinute[slot] = minute;
+    metrics.wakePerMinute[slot] = 0;
+  }
+  metrics.wakePerMinute[slot]++;
+#endif
+}
 
-  if (gKey.length() > 0)
-    gKey.toCharArray(googleApiKey, 100);
-  if (pKey.length() > 0)
-    pKey.toCharArray(picovoiceKey, 100);
-  if (wUrl.length() > 0)
-    wUrl.toCharArray(webhookUrl, 150);
+#ifdef USE_METRICS
+uint32_t metricsWakesLastHour() {
+  uint32_t now = millis() / 60000, total = 0;
+  for (int i = 0; i < 60; i++)
+    if (now - metrics.wakeMinute[i] < 60)
+      total += metrics.wakePerMinute[i];
+  return total;
+}
 
-  // 2. WiFiManager Parametreleri
-  WiFiManager wm;
+void metricsWifiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED)
+    metricInc(metrics.wifiDisconnects);
+  else if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+    metricInc(metrics.wifiConnects);
+}
 
-  // Özel Parametre kutucukları
-  WiFiManagerParameter custom_g_key("g_key", "Google API Key", googleApiKey,
-                                    100);
-  WiFiManagerParameter custom_p_key("p_key", "Picovoice AccessKey",
-                                    picovoiceKey, 100);
-  WiFiManagerParameter custom_w_url("w_url", "Webhook URL", webhookUrl, 150);
+void metricsWriteCounter(Print &out, const char *name, const char *help,
+                         uint32_t value) {
+  metricWriteHeader(out, name, "counter", help);
+  out.printf("%s %u\n", name, value);
+}
 
-  wm.addParameter(&custom_g_key);
-  wm.addParameter(&custom_p_key);
-  wm.addParameter(&custom_w_url);
+void metricsWriteGauge(Print &out, const char *name, const char *help,
+                       float value) {
+  metricWriteHeader(out, name, "gauge", help);
+  out.printf("%s %.1f\n", name, value);
+}
 
-  // Bağlanmaya çalış veya AP aç
-  Serial.println("[WiFi] Bağlanılıyor veya AP açılıyor...");
+void metricsWriteTasks(Print &out) {
+#if configUSE_TRACE_FACILITY == 1 && configGENERATE_RUN_TIME_STATS == 1
+  TaskStatus_t *tasks =
+      (TaskStatus_t *)malloc(sizeof(TaskStatus_t) * METRICS_MAX_TASKS);
+  if (!tasks)
+    return;
+  uint32_t totalRuntime = 0;
+  UBaseType_t n =
+      uxTaskGetSystemState(tasks, METRICS_MAX_TASKS, &totalRuntime);
+  metricWriteHeader(out, "alex_task_cpu_seconds_total", "counter",
+                    "FreeRTOS gorev calisma suresi (esp_timer us / 1e6)");
+  for (UBaseType_t i = 0; i < n; i++)
+    out.printf("alex_task_cpu_seconds_total{task=\"%s\"} %.3f\n",
+               tasks[i].pcTaskName, tasks[i].ulRunTimeCounter / 1e6f);
+  metricWriteHeader(out, "alex_task_stack_free_bytes", "gauge",
+                    "Gorev yiginindaki en dusuk bos alan");
+  for (UBaseType_t i = 0; i < n; i++)
+    out.printf("alex_task_stack_free_bytes{task=\"%s\"} %u\n",
+               tasks[i].pcTaskName, (unsigned)tasks[i].usStackHighWaterMark);
+  free(tasks);
+#endif
+}
 
-  // Eğer daha önce kaydedilmiş ağ varsa bağlanır, yoksa "Alex_Setup" ağı kurar.
-  bool res = wm.autoConnect("Alex_Setup"); // Şifresiz AP
+void metricsWrite(Print &out) {
+  metricWriteHeader(out, "alex_stage_latency_seconds", "histogram",
+                    "Asama suresi (STT, Gemini, TTS parcasi, webhook)");
+  for (int i = 0; i < METRIC_STAGE_COUNT; i++) {
+    char labels[24];
+    snprintf(labels, sizeof(labels), "stage=\"%s\"", METRIC_STAGE_NAMES[i]);
+    metricWriteHistogram(out, "alex_stage_latency_seconds", labels,
+                         metrics.latency[i]);
+  }
+  metricWriteHeader(out, "alex_http_responses_total", "counter",
+                    "Endpoint ve HTTP koduna gore cevaplar (negatif: baglanti "
+                    "hatasi)");
+  for (int i = 0; i < METRIC_STAGE_COUNT; i++)
+    metricWriteHttpCodes(out, "alex_http_responses_total",
+                         METRIC_STAGE_NAMES[i], metrics.httpCodes[i]);
 
-  if (!res) {
-    Serial.println("[WiFi] Bağlantı Hatası veya TimeOut");
-    // ESP.restart(); // İsterseniz reset attırabilirsiniz
-  } else {
-    Serial.println("[WiFi] Bağlandı!");
+  metricsWriteCounter(out, "alex_wake_triggers_total", "Uyanma sayisi",
+                      metricGet(metrics.wakeTriggers));
+  metricsWriteGauge(out, "alex_wake_triggers_last_hour",
+                    "Son 60 dakikadaki uyanma", metricsWakesLastHour());
+#ifdef USE_LOW_POWER_IDLE
+  float idleRatio = powerIdleRatio();
+  metricsWriteGauge(out, "alex_idle_ratio",
+                    "Dusuk guclu beklemede gecen sure orani", idleRatio);
+  metricsWriteGauge(out, "alex_idle_loop_load_ratio",
+                    "Beklemede ana dongunun CPU payi", powerIdleLoad());
+#if IDLE_CURRENT_MA > 0 && ACTIVE_CURRENT_MA > 0
+  metricsWriteGauge(out, "alex_current_estimate_ma",
+                    "Ortalama akim tahmini (elle girilen IDLE/ACTIVE_CURRENT_MA "
+                    "ile, olcum degil)",
+                    idleRatio * IDLE_CURRENT_MA +
+                        (1.0f - idleRatio) * ACTIVE_CURRENT_MA);
+#endif
+  metricsWriteGauge(out, "alex_wake_latency_us",
+                    "Son uyanma: tetik blogundan tam hiz + on kayda",
+                    powerIdle.wakeUsLast);
+  metricsWriteGauge(out, "alex_wake_latency_max_us", "En uzun uyanma",
+                    powerIdle.wakeUsMax);
+#endif
+  metricsWriteCounter(out, "alex_follow_up_turns_total",
+                      "Uyanma kelimesiz takip sorulari",
+                      metricGet(metrics.followUps));
+#ifdef USE_STREAMING_STT
+  metricWriteHeader(out, "alex_stt_stream_sessions_total", "counter",
+                    "Akisli STT oturumlari ve sonucu");
+  const char *streamResults[] = {"started", "server_end", "used", "fallback"};
+  uint32_t streamCounts[] = {sttStream.sessions, sttStream.serverEnds,
+                             sttStream.used, sttStream.fallbacks};
+  for (int i = 0; i < 4; i++)
+    out.printf("alex_stt_stream_sessions_total{result=\"%s\"} %u\n",
+               streamResults[i], streamCounts[i]);
+#endif
+#ifdef USE_SPECULATIVE_STT
+  metricWriteHeader(out, "alex_stt_speculative_total", "counter",
+                    "Duraklamada gonderilen STT istekleri ve akibeti");
+  const char *results[] = {"sent", "used", "wasted", "failed"};
+  uint32_t counts[] = {sttSpec.sent, sttSpec.used, sttSpec.wasted,
+                       sttSpec.failed};
+  for (int i = 0; i < 4; i++)
+    out.printf("alex_stt_speculative_total{result=\"%s\"} %u\n", results[i],
+               counts[i]);
+  metricsWriteCounter(out, "alex_stt_speculative_saved_ms_total",
+                      "Spekulatif STT ile kazanilan sure (ms)",
+                      (uint32_t)sttSpec.savedMs);
+#endif
+  metricsWriteCounter(out, "alex_turn_deadline_exceeded_total",
+                      "Sure tavanini asan turlar (ozur okundu)",
+                      turn.expired);
+  metricsWriteCounter(out, "alex_llm_hedged_requests_total",
+                      "p95'i asip ikinci baglantidan tekrarlanan istekler",
+                      turn.hedged);
+  metricsWriteCounter(out, "alex_llm_hedge_wins_total",
+                      "Ikinci istegin once dondugu turlar", turn.hedgeWins);
 
-    // 3. Yeni girilen değerleri kaydet (Eğer değiştiyse)
-    String newGKey = custom_g_key.getValue();
-    String newPKey = custom_p_key.getValue();
-    String newWUrl = custom_w_url.getValue();
+  metricsWriteCounter(out, "alex_device_status_answers_total",
+                      "LLM'siz, onbellekten cevaplanan durum sorulari",
+                      phraseCache.answers);
+  metricsWriteCounter(out, "alex_phrase_cache_hits_total",
+                      "Onbellekten calinan cevap sesleri", phraseCache.hits);
+  metricsWriteCounter(out, "alex_phrase_cache_misses_total",
+                      "Ilk kez sentezlenen cevap sesleri", phraseCache.misses);
 
-    if (newGKey != gKey || newPKey != pKey || newWUrl != wUrl) {
-      Serial.println("[Ayarlar] Yeni değerler kaydediliyor...");
-      preferences.putString("g_key", newGKey);
-      preferences.putString("p_key", newPKey);
-      preferences.putString("w_url", newWUrl);
+  metricsWriteCounter(out, "alex_i2s_rx_overflows_total",
+                      "Mikrofon DMA tasmalari", micHealth.overflows);
+  metricsWriteCounter(out, "alex_i2s_tx_underruns_total",
+                      "Hoparlor DMA bosalmalari", spkHealth.underruns);
+  metricsWriteCounter(out, "alex_i2s_dma_errors_total", "I2S DMA hatalari",
+                      micHealth.dmaErrors + spkHealth.dmaErrors);
+  metricsWriteCounter(out, "alex_playback_underruns_total",
+                      "Calma motorunda gec kalan tampon",
+                      playbackStats.underruns);
 
-      // RAM'deki değişkenleri de güncelle
-      newGKey.toCharArray(googleApiKey, 100);
-      newPKey.toCharArray(picovoiceKey, 100);
-      newWUrl.toCharArray(webhookUrl, 150);
+  metricsWriteGauge(out, "alex_wifi_rssi_dbm", "Wi-Fi sinyal gucu",
+                    WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : -127);
+  metricsWriteCounter(out, "alex_wifi_disconnects_total", "Wi-Fi kopmalari",
+                      metricGet(metrics.wifiDisconnects));
+  metricsWriteCounter(out, "alex_wifi_connects_total",
+                      "Wi-Fi (yeniden) baglanmalari",
+                      metricGet(metrics.wifiConnects));
+  metricsWriteCounter(out, "alex_mqtt_connects_total",
+                      "MQTT (yeniden) baglanmalari",
+                      metricGet(metrics.mqttConnects));
+
+  metricsWriteGauge(out, "alex_heap_free_bytes", "Bos dahili heap",
+                    ESP.getFreeHeap());
+  metricsWriteGauge(out, "alex_psram_free_bytes", "Bos PSRAM",
+                    ESP.getFreePsram());
+  metricsWriteGauge(out, "alex_uptime_seconds", "Acilistan beri",
+                    millis() / 1000.0f);
+  metricsWriteTasks(out);
+}
+
+// Düşük öncelikli görev: okuma işlem hattını asla bekletmez
+void metricsTask(void *arg) {
+  WiFiServer server(METRICS_PORT);
+  server.begin();
+  for (;;) {
+    WiFiClient client = server.available();
+    if (!client) {
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
+    }
+    client.setTimeout(2); // sn
+    String request = client.readStringUntil('\n');
+    // Başlıkları boş satıra kadar atla
+    for (int i = 0; i < 32 && client.connected(); i++) {
+      String line = client.readStringUntil('\n');
+      if (line.length() <= 1)
+        break;
+    }
+    if (request.startsWith("GET /metrics")) {
+      client.print("HTTP/1.1 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4\r\n"
+                   "Connection: close\r\n\r\n");
+      metricsWrite(client);
+    } else {
+      client.print("HTTP/1.1 404 Not Found\r\nConnection: close\r\n\r\n");
     }
+    client.stop();
   }
-  preferences.end();
+}
+#endif
 
-  Serial.printf("[WiFi] IP: %s\n", WiFi.localIP().toString().c_str());
+void metricsInit() {
+#ifdef USE_METRICS
+  WiFi.onEvent(metricsWifiEvent);
+  xTaskCreatePinnedToCore(metricsTask, "metrics", 6144, NULL, 1, NULL, 0);
+  Serial.printf("[Metrik] http://%s:%d/metrics\n",
+                WiFi.localIP().toString().c_str(), METRICS_PORT);
+#endif
 }
 
 // ============================================
-//  AKILLI EV (WEBHOOK) TETİKLEME
+//  BELLEK TELEMETRİSİ
 // ============================================
-void executeSmartHomeCommand(String action, String device) {
-  if (String(SMART_HOME_WEBHOOK_URL) == "YOUR_WEBHOOK_URL_HERE" ||
-      String(SMART_HOME_WEBHOOK_URL) == "") {
-    Serial.println(
-        "[SmartHome] HATA: Webhook URL ayarlanmamış! (config.h'a bak)");
-    return;
+void memTelemetryInit() {
+  for (int i = 0; i < 4; i++) {
+    memStages[i] = {0, 0, 0, 0, UINT32_MAX, UINT32_MAX, UINT32_MAX,
+                    UINT32_MAX};
   }
+  memRingHead = 0;
+  memSampleCount = 0;
+}
 
-  // URL oluşturma (Basit string değişimi: {event} -> action_device)
-  // Örnek: action="turn_on", device="light" -> event="turn_on_light"
-  String eventName = action + "_" + device;
-  String url = SMART_HOME_WEBHOOK_URL;
+// Anlık durumu aşamanın en düşük değerlerine işler
+void memUpdateStage(MemStageStats &st, uint32_t freeHeap, uint32_t largestHeap,
+                    uint32_t freePsram, uint32_t largestPsram) {
+  if (freeHeap < st.minFreeHeap)
+    st.minFreeHeap = freeHeap;
+  if (largestHeap < st.minLargestHeap)
+    st.minLargestHeap = largestHeap;
+  if (freePsram < st.minFreePsram)
+    st.minFreePsram = freePsram;
+  if (largestPsram < st.minLargestPsram)
+    st.minLargestPsram = largestPsram;
+}
 
-  // URL içinde {event} varsa değiştir (IFTTT tarzı)
-  url.replace("{event}", eventName);
+uint32_t memFragPercent(uint32_t freeBytes, uint32_t largest) {
+  if (freeBytes == 0)
+    return 0;
+  return 100 - (uint32_t)((uint64_t)largest * 100 / freeBytes);
+}
 
-  // Eğer URL'de {event} yoksa, query parametresi olarak ekleyelim (Home
-  // Assistant/Generic tarzı) Bu kısım ihtiyaca göre özelleştirilebilir.
-  if (url.indexOf("webhook") == -1 && url.indexOf("trigger") == -1) {
-    // Basit ekleme
+void memDumpHistory(int count) {
+  if (count > (int)memSampleCount)
+    count = memSampleCount;
+  Serial.printf("[Bellek] Son %d geçiş:\n", count);
+  for (int i = count; i > 0; i--) {
+    const MemSample &m =
+        memRing[(memRingHead + MEM_RING_LEN - i) % MEM_RING_LEN];
+    Serial.printf("  %7lu ms %-9s>%-9s heap %6u (blok %6u) psram %7u "
+                  "(blok %7u)\n",
+                  (unsigned long)m.at, STATE_NAMES[m.from], STATE_NAMES[m.to],
+                  m.freeHeap, m.largestHeap, m.freePsram, m.largestPsram);
   }
+}
 
-  Serial.println("[SmartHome] İstek: " + url);
-
-  WiFiClientSecure client;
-  client.setInsecure();
-  HTTPClient http;
-
-  // Webhook genelde GET veya POST olur. IFTTT GET kullanabilir.
-  http.begin(client, url);
-
-  int httpCode = http.GET(); // veya http.POST("");
+// Ana görevden çağrılır (kayıt, KWS, TTS ayırmaları)
+void *memTrackAlloc(size_t bytes, bool psram, const char *tag) {
+  MemStageStats &st = memStages[currentState];
+  void *p = psram ? ps_malloc(bytes) : malloc(bytes);
+  st.allocs++;
+  st.bytes += bytes;
+  if (bytes > st.largestRequest)
+    st.largestRequest = bytes;
+  uint32_t largest = psram ? ESP.getMaxAllocPsram() : ESP.getMaxAllocHeap();
+  memUpdateStage(st, ESP.getFreeHeap(), ESP.getMaxAllocHeap(),
+                 ESP.getFreePsram(), ESP.getMaxAllocPsram());
+  if (!p) {
+    st.failures++;
+    Serial.printf("[Bellek] HATA: %s için %u bayt ayrılamadı (%s, %s): boş "
+                  "%u, en büyük blok %u\n",
+                  tag, (unsigned)bytes, psram ? "PSRAM" : "heap",
+                  STATE_NAMES[currentState],
+                  psram ? ESP.getFreePsram() : ESP.getFreeHeap(), largest);
+    memDumpHistory(MEM_HISTORY_ON_FAIL);
+  }
+  return p;
+}
 
-  if (httpCode > 0) {
-    Serial.printf("[SmartHome] Başarılı! Kod: %d\n", httpCode);
-  } else {
-    Serial.printf("[SmartHome] Hata: %s\n",
-                  http.errorToString(httpCode).c_str());
+void memCheckFragmentation(int which, const char *name, uint32_t freeBytes,
+                           uint32_t largest) {
+  uint32_t frag = memFragPercent(freeBytes, largest);
+  if (!memFragAlert[which] && freeBytes >= MEM_FRAG_MIN_FREE &&
+      frag >= MEM_FRAG_ALERT_PCT) {
+    memFragAlert[which] = true;
+    Serial.printf("[Bellek] UYARI: %s parçalanması %%%u (boş %u, en büyük "
+                  "blok %u)\n",
+                  name, frag, freeBytes, largest);
+  } else if (memFragAlert[which] && frag < MEM_FRAG_CLEAR_PCT) {
+    memFragAlert[which] = false;
+    Serial.printf("[Bellek] %s parçalanması düzeldi: %%%u\n", name, frag);
   }
+}
 
-  http.end();
+// Her setState() geçişinde: halkaya örnek + çıkılan/girilen aşama
+void memSample(uint8_t from, uint8_t to) {
+  MemSample &m = memRing[memRingHead];
+  m.at = millis();
+  m.from = from;
+  m.to = to;
+  m.freeHeap = ESP.getFreeHeap();
+  m.largestHeap = ESP.getMaxAllocHeap();
+  m.freePsram = ESP.getFreePsram();
+  m.largestPsram = ESP.getMaxAllocPsram();
+  memRingHead = (memRingHead + 1) % MEM_RING_LEN;
+  memSampleCount++;
+
+  memUpdateStage(memStages[from], m.freeHeap, m.largestHeap, m.freePsram,
+                 m.largestPsram);
+  memUpdateStage(memStages[to], m.freeHeap, m.largestHeap, m.freePsram,
+                 m.largestPsram);
+  memCheckFragmentation(0, "Heap", m.freeHeap, m.largestHeap);
+  memCheckFragmentation(1, "PSRAM", m.freePsram, m.largestPsram);
 }
 
-// ============================================
-//  YARDIMCI FONKSİYONLAR
-// ============================================
-float calculateRMS(int samplesRead) {
-  long long sum = 0;
-  for (int i = 0; i < samplesRead; i++) {
-    int32_t s = rawBuffer[i] >> 14;
-    sum += (long long)s * s;
+// Sadece son rapordan beri geçiş olduysa (IDLE'da her seferinde değil)
+void memReport() {
+  static uint32_t reportedSamples = 0;
+  if (memSampleCount - reportedSamples < 4)
+    return;
+  reportedSamples = memSampleCount;
+  uint32_t heapSize = ESP.getHeapSize(), psramSize = ESP.getPsramSize();
+  Serial.printf("[Bellek] heap en düşük: %u / %u, PSRAM en düşük: %u / %u\n",
+                ESP.getMinFreeHeap(), heapSize, ESP.getMinFreePsram(),
+                psramSize);
+  for (int i = 0; i < 4; i++) {
+    const MemStageStats &st = memStages[i];
+    if (st.minFreeHeap == UINT32_MAX)
+      continue;
+    Serial.printf("  %-9s ayırma %4u (%3u hata) %7u KB, en büyük istek %6u | "
+                  "tepe heap %6u, PSRAM %7u | en küçük blok %6u / %7u\n",
+                  STATE_NAMES[i], st.allocs, st.failures, st.bytes / 1024,
+                  st.largestRequest, heapSize - st.minFreeHeap,
+                  psramSize - st.minFreePsram, st.minLargestHeap,
+                  st.minLargestPsram);
   }
-  return sqrt((float)sum / samplesRead);
 }
 
-void setState(SystemState s) {
-  currentState = s;
-  const char *names[] = {"IDLE", "LISTENING", "THINKING", "SPEAKING"};
-  Serial.printf("\n[DURUM] >>> %s\n", names[s]);
-  if (s == STATE_IDLE || s == STATE_LISTENING) {
-    lastSoundTime = millis();
-    soundDetected = false;
-  }
+void frontEndReport() {
+  if (frontEnd.blocks == 0)
+    return;
+  Serial.printf("[AFE] Kazanç: %.1fx, RMS: %u, limiter: %u blok | "
+                "%.1f us/blok, CPU %%%.2f\n",
+                frontEnd.gain / 65536.0f, frontEnd.lastRms, frontEnd.limited,
+                (float)frontEnd.cycles / frontEnd.blocks /
+                    getCpuFrequencyMhz(),
+                afeCpuPercent(frontEnd, BUFFER_LENGTH, SAMPLE_RATE,
+                              getCpuFrequencyMhz() * 1000000UL));
+#ifdef USE_NOISE_SUPPRESSION
+  if (noiseSuppressor.blocks == 0)
+    return;
+  Serial.printf("[NS] Bastırma: %.1f dB (son çerçeve), öğrenilen çerçeve: %u "
+                "| %.1f us/blok\n",
+                nsAttenuationDb(noiseSuppressor),
+                noiseSuppressor.learnedFrames,
+                (float)noiseSuppressor.cycles / noiseSuppressor.blocks /
+                    getCpuFrequencyMhz());
+#endif
 }
 
 void i2s_mic_init() {
-  i2s_config_t cfg = {.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-                      .sample_rate = SAMPLE_RATE,
-                      .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
-                      .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-                      .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-                      .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-                      .dma_buf_count = 8,
-                      .dma_buf_len = BUFFER_LENGTH,
-                      .use_apll = false,
-                      .tx_desc_auto_clear = false,
-                      .fixed_mclk = 0};
-  i2s_pin_config_t pins = {.bck_io_num = MIC_SCK_PIN,
-                           .ws_io_num = MIC_WS_PIN,
-                           .data_out_num = I2S_PIN_NO_CHANGE,
-                           .data_in_num = MIC_SD_PIN};
-  i2s_driver_install(MIC_PORT, &cfg, 0, NULL);
-  i2s_set_pin(MIC_PORT, &pins);
-  i2s_zero_dma_buffer(MIC_PORT);
-  Serial.println("[I2S] Mikrofon hazır.");
+  if (!i2sInstall(micHealth)) {
+    Serial.println("[I2S] Mikrofon başlatılamadı!");
+    return;
+  }
+  xTaskCreatePinnedToCore(i2sEventTask, "i2s_mic_ev", 2048, &micHealth, 4,
+                          NULL, 0);
+  Serial.printf("[I2S] Mikrofon hazır (%s, %.0f ms DMA).\n",
+                micHealth.profile.name, audioPortDelayMs(micHealth));
 }
 
 void i2s_speaker_init() {
-  i2s_config_t cfg = {.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
-                      .sample_rate = SAMPLE_RATE,
-                      .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-                      .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-                      .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-                      .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-                      .dma_buf_count = 8,
-                      .dma_buf_len = BUFFER_LENGTH,
-                      .use_apll = false,
-                      .tx_desc_auto_clear = true,
-                      .fixed_mclk = 0};
-  i2s_pin_config_t pins = {.bck_io_num = SPK_BCLK_PIN,
-                           .ws_io_num = SPK_LRC_PIN,
-                           .data_out_num = SPK_DIN_PIN,
-                           .data_in_num = I2S_PIN_NO_CHANGE};
-  i2s_driver_install(SPK_PORT, &cfg, 0, NULL);
-  i2s_set_pin(SPK_PORT, &pins);
-  i2s_zero_dma_buffer(SPK_PORT);
-  Serial.println("[I2S] Hoparlör hazır.");
+  if (!i2sInstall(spkHealth)) {
+    Serial.println("[I2S] Hoparlör başlatılamadı!");
+    return;
+  }
+  xTaskCreatePinnedToCore(i2sEventTask, "i2s_spk_ev", 2048, &spkHealth, 4,
+                          NULL, 0);
+  Serial.printf("[I2S] Hoparlör hazır (%s, %.0f ms DMA).\n",
+                spkHealth.profile.name, audioPortDelayMs(spkHealth));
 }
 
 // ============================================
 //  WAKE WORD ALGILAMA (Picovoice)
 // ============================================
+// Model flash'tan eşli okunur; Porcupine'e kopya değil işaretçi verilir
+void wakeWordInit() {
+#ifdef USE_WAKE_WORD
+  if (!wakeModel.data) {
+    Serial.println("[Porcupine] Model yok: wakemodel bölümüne yükleyin.");
+    return;
+  }
+  pv_status_t status = pv_porcupine_init(
+      PICOVOICE_ACCESS_KEY, wakeModel.size, wakeModel.data,
+      0.5f, // Hassasiyet (0..1)
+      memory_buffer, MEMORY_BUFFER_SIZE, &porcupine);
+
+  if (status != PV_STATUS_SUCCESS) {
+    Serial.printf("[Porcupine] Init Hatası: %s\n", pv_status_to_string(status));
+    porcupine = NULL;
+  } else {
+    Serial.printf("[Porcupine] '%s' v%u motoru hazır!\n",
+                  wakeModel.header.name, wakeModel.header.version);
+  }
+#endif
+}
+
 bool detectWakeWord(int32_t *buffer, size_t length) {
 #ifdef USE_WAKE_WORD
   if (porcupine == NULL)
@@ -828,9 +4722,7 @@ bool detectWakeWord(int32_t *buffer, size_t length) {
 
   // Sadece ilk frame'i alıp deneyelim (Örnek amaçlı basitleştirilmiş)
   int16_t pcmFrame[frameLength];
-  for (int i = 0; i < frameLength; i++) {
-    pcmFrame[i] = (int16_t)(buffer[i] >> 16);
-  }
+  MicAudio::toPcm16(buffer, pcmFrame, frameLength);
 
   pv_status_t status =
       pv_porcupine_process(porcupine, pcmFrame, &keyword_index);
@@ -852,20 +4744,32 @@ void resetHistory() {
 // ============================================
 //  LED EFEKTLERİ
 // ============================================
+// Ana döngü ses işlerken (THINKING/SPEAKING) de animasyon sürsün diye ayrı
+// görevde çalışır. ESP32'de NeoPixel show() RMT donanımıyla sürülür.
+void ledTask(void *arg) {
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    handleLedEffects();
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(LED_FRAME_MS));
+  }
+}
+
+void ledInit() {
+  strip.begin();
+  strip.setBrightness(50); // %20 parlaklık yeterli
+  strip.show();            // Söndür (siyah)
+  xTaskCreatePinnedToCore(ledTask, "led", 3072, NULL, 3, NULL, 0);
+}
+
 void handleLedEffects() {
-  static unsigned long lastUpdate = 0;
   static int brightness = 0;
   static int fadeAmount = 5;
   static int hue = 0;
+  static int envelope = 0;
 
-  unsigned long currentMillis = millis();
-
-  // Her 20ms'de bir güncelle (50 FPS)
-  if (currentMillis - lastUpdate < 20)
-    return;
-  lastUpdate = currentMillis;
+  SystemState state = currentState; // Tek okuma, kare boyunca sabit
 
-  switch (currentState) {
+  switch (state) {
   case STATE_IDLE:
     // Mavi Nefes Alma Efekti (Breathing)
     strip.setPixelColor(0, strip.Color(0, 0, brightness));
@@ -888,11 +4792,14 @@ void handleLedEffects() {
       hue = 0;
     break;
 
-  case STATE_SPEAKING:
-    // Mor Rastgele Parlama
-    int b = random(50, 200);
+  case STATE_SPEAKING: {
+    // Mor, çalınan sesin zarfını izler (hızlı yükselir, yavaş söner)
+    int level = playbackEnvelope;
+    envelope = (level > envelope) ? level : max(envelope - 8, 0);
+    int b = 30 + (envelope * 170) / 255;
     strip.setPixelColor(0, strip.Color(b, 0, b));
     break;
   }
+  }
   strip.show();
 }
@@ -0,0 +1,299 @@
+#ifndef EARCONS_H
+#define EARCONS_H
+
+// ============================================
+//  EFEKT SESLERİ (Flash'ta IMA ADPCM)
+// ============================================
+//  16 kHz, 4 bit/örnek IMA ADPCM (düşük nibble önce). Flash'tan doğrudan
+//  okunur, RAM'e açılmaz; çözme örnek başına birkaç tamsayı işlemi.
+//   EARCON_WAKE  : 988 Hz 60 ms + 1319 Hz 90 ms (yükselen, "dinliyorum")
+//   EARCON_THINK : 1319 Hz 50 ms + 988 Hz 70 ms (inen, "düşünüyorum")
+//   EARCON_PULSE : 660 Hz 60 ms, düşünme döngüsünde aralıklı tekrarlanır
+//  Her nota: 5 ms atak, üstel sönüm, 2. harmonik %25.
+
+#include <stdint.h>
+
+struct Earcon {
+  const uint8_t *adpcm;
+  uint32_t samples;
+};
+
+struct AdpcmState {
+  int32_t predictor;
+  int index;
+};
+
+static const int16_t ADPCM_STEP[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+static const int8_t ADPCM_INDEX[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+inline void adpcmReset(AdpcmState &s) {
+  s.predictor = 0;
+  s.index = 0;
+}
+
+// pos: örnek indeksi (ardışık çağrılmalı; durum her örnekte ilerler)
+inline int16_t adpcmNext(AdpcmState &s, const uint8_t *data, uint32_t pos) {
+  uint8_t code = (data[pos >> 1] >> ((pos & 1) * 4)) & 0x0F;
+  int step = ADPCM_STEP[s.index];
+  int32_t diff = step >> 3;
+  if (code & 4)
+    diff += step;
+  if (code & 2)
+    diff += step >> 1;
+  if (code & 1)
+    diff += step >> 2;
+  s.predictor += (code & 8) ? -diff : diff;
+  if (s.predictor > 32767)
+    s.predictor = 32767;
+  if (s.predictor < -32768)
+    s.predictor = -32768;
+  s.index += ADPCM_INDEX[code & 7];
+  if (s.index < 0)
+    s.index = 0;
+  if (s.index > 88)
+    s.index = 88;
+  return (int16_t)s.predictor;
+}
+
+const uint8_t EARCON_WAKE_ADPCM[] = {
+    0x70, 0x77, 0x57, 0xaa, 0xcb, 0xce, 0xbb, 0x60, 0x55, 0x22, 0x98, 0xab,
+    0xab, 0xdc, 0xab, 0x40, 0x37, 0x14, 0x90, 0xba, 0xaa, 0xcb, 0xac, 0x30,
+    0x47, 0x23, 0x90, 0xba, 0xab, 0xcb, 0xbc, 0x38, 0x47, 0x33, 0x90, 0xba,
+    0xba, 0xcb, 0xbc, 0x18, 0x47, 0x33, 0x80, 0xba, 0xaa, 0xbb, 0xbc, 0x2a,
+    0x56, 0x33, 0x81, 0xb9, 0xab, 0xbb, 0xcc, 0x09, 0x64, 0x33, 0x82, 0xb9,
+    0xab, 0xba, 0xcc, 0x89, 0x54, 0x24, 0x02, 0xa9, 0xab, 0xaa, 0xcb, 0x0b,
+    0x72, 0x34, 0x12, 0xa9, 0xab, 0xba, 0xcb, 0x9b, 0x73, 0x34, 0x03, 0xa8,
+    0xab, 0xba, 0xdb, 0x9a, 0x51, 0x45, 0x12, 0x99, 0xaa, 0xa9, 0xbb, 0x9c,
+    0x50, 0x35, 0x23, 0xa8, 0xba, 0xba, 0xcb, 0x9c, 0x48, 0x45, 0x13, 0x90,
+    0xaa, 0xab, 0xba, 0xad, 0x20, 0x46, 0x33, 0x90, 0xab, 0xba, 0xca, 0xbb,
+    0x28, 0x57, 0x13, 0x91, 0xa9, 0x9b, 0xba, 0xbc, 0x29, 0x65, 0x23, 0x81,
+    0xaa, 0xaa, 0xba, 0xbc, 0x1a, 0x65, 0x33, 0x81, 0xb9, 0xaa, 0xbb, 0xdb,
+    0x0a, 0x54, 0x34, 0x82, 0xa9, 0xba, 0xaa, 0xbc, 0x8a, 0x73, 0x35, 0x01,
+    0x99, 0x9b, 0xaa, 0xcb, 0x9a, 0x63, 0x44, 0x02, 0xa8, 0xaa, 0xaa, 0xca,
+    0x9a, 0x61, 0x34, 0x13, 0xa8, 0xab, 0xab, 0xdb, 0x9b, 0x41, 0x37, 0x22,
+    0xa8, 0xaa, 0xaa, 0xcb, 0xab, 0x50, 0x45, 0x22, 0x98, 0xaa, 0xaa, 0xca,
+    0xab, 0x30, 0x47, 0x23, 0x90, 0xaa, 0xab, 0xca, 0xab, 0x39, 0x47, 0x14,
+    0x80, 0xa9, 0x9a, 0xba, 0xbb, 0x29, 0x47, 0x24, 0x80, 0xa9, 0xaa, 0xaa,
+    0xac, 0x09, 0x55, 0x33, 0x82, 0xba, 0xba, 0xba, 0xbd, 0x09, 0x64, 0x24,
+    0x01, 0xa9, 0xaa, 0xaa, 0xcb, 0x8a, 0x54, 0x34, 0x02, 0xa9, 0xab, 0xba,
+    0xdb, 0x8a, 0x62, 0x25, 0x12, 0xa9, 0xaa, 0xaa, 0xbb, 0x9c, 0x62, 0x35,
+    0x02, 0x98, 0xab, 0xaa, 0xcb, 0x9b, 0x51, 0x36, 0x13, 0xa8, 0xba, 0xaa,
+    0xcb, 0xab, 0x50, 0x36, 0x23, 0x98, 0xab, 0xab, 0xcb, 0xbb, 0x58, 0x55,
+    0x22, 0x90, 0xaa, 0xaa, 0xba, 0xac, 0x28, 0x47, 0x13, 0x91, 0xaa, 0xaa,
+    0xba, 0xbc, 0x29, 0x47, 0x23, 0x91, 0xb9, 0xaa, 0xbb, 0xbc, 0x19, 0x56,
+    0x33, 0x81, 0xaa, 0xab, 0xca, 0xbb, 0x1a, 0x65, 0x43, 0x81, 0xa9, 0xaa,
+    0xa9, 0xac, 0x0a, 0x73, 0x24, 0x02, 0xa9, 0x9b, 0xba, 0xbb, 0x8c, 0x73,
+    0x34, 0x02, 0xa9, 0xaa, 0xba, 0xcb, 0x8b, 0x62, 0x35, 0x03, 0xa8, 0xab,
+    0xba, 0xcb, 0x9b, 0x61, 0x35, 0x13, 0x98, 0xbb, 0xba, 0xcb, 0xbb, 0x61,
+    0x45, 0x12, 0x98, 0xaa, 0xa9, 0xbb, 0x9c, 0x48, 0x55, 0x12, 0x90, 0xaa,
+    0xa9, 0xba, 0xac, 0x38, 0x47, 0x22, 0x90, 0xb9, 0x9a, 0xca, 0xba, 0x28,
+    0x56, 0x23, 0x80, 0xaa, 0xab, 0xba, 0xac, 0x2a, 0x46, 0x34, 0x80, 0xa9,
+    0xab, 0xb9, 0xbc, 0x09, 0x55, 0x24, 0x01, 0xb9, 0xaa, 0xb9, 0xcb, 0x0a,
+    0x54, 0x25, 0x82, 0x99, 0x9b, 0xaa, 0xac, 0x8a, 0x72, 0x34, 0x11, 0xa9,
+    0xab, 0xb9, 0xcb, 0x9a, 0x63, 0x35, 0x12, 0xa9, 0xba, 0xaa, 0xcb, 0x9b,
+    0x71, 0x34, 0x13, 0x99, 0xbb, 0xaa, 0xdb, 0xaa, 0x41, 0x46, 0x12, 0x98,
+    0xaa, 0x9a, 0xca, 0xaa, 0x40, 0x45, 0x13, 0x90, 0xba, 0xaa, 0xca, 0xbb,
+    0x30, 0x57, 0x22, 0x90, 0xb9, 0xa9, 0xba, 0xac, 0x39, 0x46, 0x24, 0x90,
+    0xa9, 0xaa, 0xaa, 0xac, 0x19, 0x46, 0x33, 0x81, 0xba, 0xab, 0xca, 0xbb,
+    0x1a, 0x56, 0x24, 0x81, 0xa9, 0xaa, 0xaa, 0xcb, 0x0a, 0x64, 0x43, 0x01,
+    0x0f, 0x10, 0x98, 0xaa, 0xcd, 0x29, 0x57, 0x02, 0xaa, 0xba, 0xcc, 0x29,
+    0x47, 0x02, 0xb9, 0xaa, 0xcb, 0x1a, 0x57, 0x02, 0xa9, 0x9a, 0xbb, 0x1b,
+    0x57, 0x12, 0xa9, 0xaa, 0xca, 0x0a, 0x65, 0x12, 0xa9, 0xa9, 0xba, 0x0b,
+    0x65, 0x13, 0xa8, 0x9b, 0xbb, 0x8c, 0x64, 0x13, 0xa8, 0x9a, 0xba, 0x9b,
+    0x74, 0x13, 0xa0, 0xaa, 0xaa, 0x8c, 0x62, 0x14, 0x90, 0xaa, 0xb9, 0xaa,
+    0x72, 0x24, 0x98, 0xa9, 0xb9, 0xaa, 0x71, 0x24, 0x90, 0xaa, 0xa9, 0xab,
+    0x61, 0x34, 0x90, 0xaa, 0xaa, 0xbb, 0x70, 0x34, 0x91, 0xaa, 0xaa, 0xbb,
+    0x68, 0x35, 0x91, 0xaa, 0xa9, 0xbb, 0x59, 0x36, 0x81, 0xaa, 0xa9, 0xbb,
+    0x49, 0x46, 0x01, 0xaa, 0xa9, 0xba, 0x39, 0x47, 0x01, 0xa9, 0x9a, 0xba,
+    0x19, 0x47, 0x82, 0x99, 0x9a, 0xba, 0x1a, 0x56, 0x02, 0xa9, 0xa9, 0xaa,
+    0x0a, 0x46, 0x03, 0xb8, 0x9a, 0xbb, 0x8a, 0x56, 0x13, 0xa9, 0x9a, 0xca,
+    0x0a, 0x73, 0x13, 0xa8, 0x9a, 0xba, 0x8c, 0x73, 0x23, 0xa8, 0xaa, 0xba,
+    0x9b, 0x64, 0x14, 0xa0, 0xa9, 0xb9, 0x9b, 0x73, 0x14, 0x90, 0x9a, 0xaa,
+    0x9b, 0x71, 0x14, 0x80, 0xaa, 0xa9, 0xab, 0x61, 0x34, 0x90, 0xaa, 0xaa,
+    0xbb, 0x61, 0x35, 0x91, 0xaa, 0xaa, 0xac, 0x40, 0x26, 0x81, 0xaa, 0xa9,
+    0xab, 0x48, 0x36, 0x82, 0xba, 0xaa, 0xbb, 0x59, 0x36, 0x82, 0xaa, 0xaa,
+    0xcb, 0x28, 0x37, 0x02, 0xaa, 0xaa, 0xcb, 0x29, 0x46, 0x02, 0xa9, 0xaa,
+    0xba, 0x2a, 0x47, 0x02, 0xa9, 0x9a, 0xba, 0x1b, 0x47, 0x02, 0xa8, 0x9a,
+    0xab, 0x0b, 0x56, 0x12, 0xa9, 0xa9, 0xaa, 0x8b, 0x65, 0x12, 0xa8, 0xa9,
+    0xaa, 0x8b, 0x64, 0x23, 0xa8, 0xaa, 0xbb, 0x9b, 0x74, 0x23, 0xa0, 0x9b,
+    0xba, 0x9c, 0x72, 0x23, 0x90, 0xab, 0xaa, 0x9c, 0x71, 0x23, 0x90, 0xaa,
+    0xba, 0xab, 0x71, 0x25, 0x90, 0x9a, 0xa9, 0xab, 0x60, 0x34, 0x80, 0xab,
+    0xb9, 0xab, 0x50, 0x36, 0x91, 0xaa, 0xa9, 0xbb, 0x58, 0x36, 0x81, 0xaa,
+    0xaa, 0xbb, 0x48, 0x37, 0x81, 0xa9, 0xaa, 0xbb, 0x49, 0x46, 0x01, 0x9a,
+    0xaa, 0xba, 0x39, 0x47, 0x01, 0xa9, 0xa9, 0xba, 0x19, 0x37, 0x03, 0xb9,
+    0xaa, 0xbb, 0x1b, 0x57, 0x03, 0xa9, 0x9a, 0xba, 0x1b, 0x65, 0x12, 0x99,
+    0xaa, 0xaa, 0x0b, 0x55, 0x23, 0xa9, 0x9b, 0xbb, 0x8b, 0x65, 0x23, 0xa8,
+    0xab, 0xba, 0x9b, 0x74, 0x14, 0x98, 0x9a, 0xaa, 0x9a, 0x63, 0x24, 0x98,
+    0xaa, 0xb9, 0x9b, 0x72, 0x24, 0x90, 0xaa, 0xaa, 0xab, 0x72, 0x24, 0x90,
+    0xaa, 0xa9, 0xab, 0x70, 0x24, 0x80, 0xaa, 0xaa, 0xba, 0x60, 0x25, 0x91,
+    0x9a, 0xaa, 0xba, 0x40, 0x27, 0x81, 0xa9, 0xaa, 0xba, 0x48, 0x36, 0x82,
+    0xaa, 0xaa, 0xac, 0x39, 0x47, 0x81, 0xa9, 0x99, 0xba, 0x29, 0x37, 0x02,
+    0xaa, 0x9a, 0xcb, 0x29, 0x46, 0x02, 0xb9, 0xa9, 0xba, 0x1a, 0x47, 0x02,
+    0x99, 0xaa, 0xba, 0x1a, 0x65, 0x12, 0xa9, 0xa9, 0xba, 0x0a, 0x65, 0x12,
+    0xa8, 0xaa, 0xb9, 0x0b, 0x74, 0x12, 0x98, 0xaa, 0xb9, 0x8b, 0x64, 0x23,
+    0xa8, 0xaa, 0xba, 0x8c, 0x72, 0x23, 0xa0, 0xaa, 0xba, 0x9c, 0x72, 0x23,
+    0x90, 0xab, 0xb9, 0x9c, 0x61, 0x24, 0x90, 0xaa, 0xa9, 0xab, 0x61, 0x25,
+    0x80, 0xaa, 0xaa, 0xab, 0x51, 0x26, 0x91, 0x9a, 0xaa, 0xba, 0x50, 0x35,
+    0x81, 0xba, 0xb9, 0xbb, 0x58, 0x36, 0x82, 0xba, 0xaa, 0xbb, 0x59, 0x36,
+    0x82, 0xaa, 0xaa, 0xcb, 0x28, 0x37, 0x02, 0xaa, 0xaa, 0xbb, 0x2a, 0x57,
+    0x02, 0xa9, 0x9a, 0xba, 0x19, 0x46, 0x03, 0xb9, 0xa9, 0xbb, 0x1a, 0x56,
+    0x03, 0xa9, 0x9a, 0xca, 0x0a, 0x45, 0x13, 0xb8, 0xaa, 0xba, 0x0c, 0x64,
+    0x13, 0x99, 0xaa, 0xba, 0x8b, 0x74, 0x13, 0xa8, 0xa9, 0xba, 0x8b, 0x73,
+    0x15, 0x98, 0xa9, 0xa9, 0x9a, 0x72, 0x23, 0xa0, 0xaa, 0xba, 0xab, 0x72,
+    0x25, 0x90, 0xaa, 0xa9, 0x9b, 0x61, 0x34, 0x90, 0xaa, 0xba, 0xab, 0x70,
+    0x34, 0x90, 0x9a, 0xaa, 0xac, 0x50, 0x34, 0x81, 0xab, 0xaa, 0xcb, 0x40,
+    0x36, 0x91, 0xa9, 0xaa, 0xbb, 0x48, 0x37, 0x81, 0xaa, 0xa9, 0xbb, 0x38,
+    0x57, 0x81, 0x99, 0x9a, 0xaa, 0x29, 0x46, 0x02, 0xaa, 0xa9, 0xba, 0x2a,
+    0x47, 0x02, 0xa9, 0x9a, 0xbb, 0x1a, 0x47, 0x02, 0x99, 0xaa, 0xaa, 0x1b,
+    0x65, 0x12, 0xa9, 0xa9, 0xaa, 0x0b, 0x55, 0x13, 0xa8, 0x9b, 0xbb, 0x8b,
+    0x65, 0x23, 0x99, 0xab, 0xba, 0x9b, 0x65, 0x23, 0xa8, 0xaa, 0xba, 0x8c,
+    0x72, 0x23, 0x98, 0xaa, 0xba, 0xab, 0x73, 0x25, 0x98, 0xa9, 0xa9, 0xab,
+    0x62, 0x24, 0xa1, 0x9a, 0xba, 0xab, 0x61, 0x35, 0x90, 0xaa, 0xa9, 0xac,
+    0x41, 0x35, 0x91, 0xaa, 0xaa, 0xac, 0x40, 0x36, 0x91, 0xaa, 0xa9, 0xbb,
+    0x48, 0x37, 0x81, 0x9a, 0xaa, 0xbb, 0x38, 0x57, 0x81, 0x99, 0x9a, 0xaa,
+    0x29, 0x37, 0x02, 0xaa, 0xaa, 0xbb, 0x2a, 0x57, 0x02, 0xa9, 0x9a, 0xba,
+    0x19, 0x46, 0x03, 0xb9, 0xa9, 0xbb, 0x1a, 0x56, 0x03, 0xa9, 0x9a, 0xca,
+    0x0a, 0x45, 0x13, 0xa9, 0xaa, 0xba, 0x8b, 0x75, 0x12, 0x98, 0xaa, 0xb9,
+    0x8b, 0x64, 0x23, 0xa8, 0xaa, 0xba, 0x8c, 0x72, 0x23, 0x98, 0x9b, 0xba,
+    0x9c, 0x72, 0x23, 0xa0, 0xaa, 0xb9, 0xab, 0x72, 0x34, 0xa0, 0xaa, 0xb9,
+};
+const Earcon EARCON_WAKE = {EARCON_WAKE_ADPCM, 2400};
+
+const uint8_t EARCON_THINK_ADPCM[] = {
+    0x70, 0x77, 0xa7, 0xdb, 0xcd, 0x2a, 0x67, 0x01, 0xa9, 0xb9, 0xdb, 0x29,
+    0x56, 0x02, 0xb9, 0xa9, 0xbc, 0x19, 0x47, 0x12, 0xaa, 0xaa, 0xda, 0x09,
+    0x55, 0x12, 0xa9, 0xaa, 0xca, 0x0a, 0x55, 0x13, 0xa9, 0xaa, 0xca, 0x0b,
+    0x55, 0x13, 0xa8, 0x9b, 0xcb, 0x8a, 0x64, 0x23, 0xa9, 0xaa, 0xc9, 0x8a,
+    0x73, 0x23, 0xa8, 0xaa, 0xba, 0x9b, 0x73, 0x15, 0x90, 0x9a, 0xaa, 0x9a,
+    0x62, 0x24, 0x90, 0xaa, 0xaa, 0xab, 0x71, 0x24, 0x90, 0x9a, 0xaa, 0xab,
+    0x61, 0x25, 0x80, 0xaa, 0xa9, 0xab, 0x50, 0x35, 0x91, 0xaa, 0xaa, 0xbb,
+    0x50, 0x36, 0x81, 0xaa, 0xaa, 0xbb, 0x48, 0x37, 0x81, 0xaa, 0xa9, 0xbb,
+    0x38, 0x57, 0x81, 0x99, 0x9a, 0xaa, 0x29, 0x37, 0x82, 0xa9, 0xaa, 0xca,
+    0x29, 0x55, 0x02, 0xa9, 0x9a, 0xba, 0x1a, 0x56, 0x02, 0xa9, 0xa9, 0xaa,
+    0x0a, 0x46, 0x03, 0xa9, 0x9a, 0xba, 0x0b, 0x65, 0x13, 0xa9, 0x9a, 0xba,
+    0x8b, 0x65, 0x22, 0x99, 0xaa, 0xaa, 0x8b, 0x73, 0x15, 0x98, 0x9a, 0xa9,
+    0x9a, 0x63, 0x14, 0x98, 0x9a, 0xb9, 0x9b, 0x73, 0x33, 0x98, 0xab, 0xaa,
+    0xac, 0x62, 0x34, 0x98, 0xaa, 0xb9, 0xab, 0x71, 0x24, 0x91, 0xaa, 0xb9,
+    0xab, 0x60, 0x25, 0x91, 0xa9, 0xaa, 0xab, 0x50, 0x35, 0x81, 0xba, 0xb9,
+    0xbb, 0x58, 0x36, 0x92, 0xb9, 0xb9, 0xbb, 0x48, 0x37, 0x82, 0xaa, 0xaa,
+    0xbb, 0x39, 0x57, 0x01, 0xa9, 0x99, 0xab, 0x29, 0x46, 0x02, 0xa9, 0xaa,
+    0xba, 0x1a, 0x47, 0x02, 0xa9, 0xa9, 0xba, 0x1a, 0x56, 0x02, 0xa8, 0x9a,
+    0xba, 0x0a, 0x55, 0x13, 0xa9, 0xaa, 0xba, 0x8b, 0x56, 0x13, 0xa8, 0x9b,
+    0xba, 0x8b, 0x74, 0x13, 0xa8, 0x9a, 0xba, 0x8b, 0x73, 0x15, 0x98, 0xa9,
+    0xa9, 0x9a, 0x72, 0x23, 0x98, 0xaa, 0xaa, 0x9c, 0x52, 0x25, 0x90, 0xaa,
+    0xa9, 0xab, 0x61, 0x25, 0x90, 0x9a, 0xaa, 0xaa, 0x60, 0x34, 0x90, 0xaa,
+    0xa9, 0x9c, 0x58, 0x34, 0x91, 0xaa, 0xaa, 0xbb, 0x58, 0x36, 0x81, 0xaa,
+    0x9a, 0xac, 0x38, 0x37, 0x82, 0xaa, 0xaa, 0xbb, 0x49, 0x46, 0x01, 0x9a,
+    0x9a, 0xbb, 0x39, 0x37, 0x03, 0xba, 0xaa, 0xbb, 0x2a, 0x57, 0x02, 0xa9,
+    0xa9, 0xba, 0x1a, 0x37, 0x13, 0xb9, 0xaa, 0xcb, 0x1a, 0x55, 0x13, 0xa9,
+    0xaa, 0xca, 0x0a, 0x64, 0x12, 0xa8, 0x9a, 0xba, 0x8a, 0x64, 0x23, 0x99,
+    0x9b, 0xbb, 0x8b, 0x74, 0x23, 0xa8, 0xaa, 0xba, 0x9b, 0x73, 0x25, 0x98,
+    0x9a, 0xaa, 0x9a, 0x62, 0x24, 0xa0, 0xa9, 0xaa, 0xab, 0x71, 0x24, 0x90,
+    0x9a, 0xaa, 0xab, 0x61, 0x25, 0x80, 0xaa, 0xa9, 0xbb, 0x51, 0x35, 0x91,
+    0xaa, 0xaa, 0xbb, 0x68, 0x35, 0x91, 0xb9, 0xa9, 0xbb, 0x59, 0x36, 0x81,
+    0xaa, 0xa9, 0xbb, 0x49, 0x46, 0x81, 0xa9, 0xa9, 0xba, 0x28, 0x37, 0x83,
+    0xb9, 0xaa, 0xbb, 0x2a, 0x57, 0x02, 0xa9, 0xa9, 0xba, 0x2a, 0x46, 0x03,
+    0xa9, 0xaa, 0xbb, 0x0a, 0x37, 0x22, 0x81, 0xba, 0xeb, 0xdc, 0x9c, 0x48,
+    0x37, 0x23, 0x98, 0xcb, 0xaa, 0xcc, 0xbb, 0x50, 0x46, 0x22, 0x90, 0xab,
+    0xab, 0xdb, 0xac, 0x30, 0x56, 0x13, 0x90, 0xaa, 0xaa, 0xcb, 0xac, 0x39,
+    0x47, 0x23, 0x80, 0xab, 0xab, 0xca, 0xbc, 0x18, 0x56, 0x23, 0x91, 0xb9,
+    0xaa, 0xba, 0xbc, 0x2a, 0x65, 0x33, 0x81, 0xaa, 0xab, 0xba, 0xcc, 0x09,
+    0x54, 0x34, 0x81, 0xa9, 0xaa, 0xba, 0xcb, 0x8a, 0x64, 0x24, 0x02, 0xa9,
+    0xab, 0xb9, 0xcb, 0x8a, 0x73, 0x34, 0x02, 0xa9, 0xaa, 0xab, 0xcb, 0x8b,
+    0x72, 0x34, 0x12, 0xa8, 0xab, 0xab, 0xdb, 0x9a, 0x51, 0x45, 0x02, 0x98,
+    0xaa, 0xa9, 0xbb, 0xab, 0x60, 0x45, 0x22, 0x98, 0xba, 0x9a, 0xbb, 0xac,
+    0x40, 0x55, 0x22, 0x88, 0xba, 0xa9, 0xca, 0xba, 0x20, 0x47, 0x23, 0x90,
+    0xaa, 0x9b, 0xbb, 0xbc, 0x28, 0x47, 0x23, 0x91, 0xaa, 0xba, 0xba, 0xbc,
+    0x19, 0x56, 0x24, 0x80, 0xa9, 0x9a, 0xba, 0xbb, 0x1a, 0x56, 0x24, 0x81,
+    0xa9, 0xaa, 0xb9, 0xcb, 0x0a, 0x64, 0x43, 0x01, 0xa9, 0xaa, 0xaa, 0xcb,
+    0x0a, 0x72, 0x34, 0x01, 0x99, 0xab, 0xb9, 0xcb, 0x9a, 0x63, 0x35, 0x02,
+    0xa8, 0xba, 0xaa, 0xcb, 0x9b, 0x62, 0x35, 0x13, 0x99, 0xbb, 0xaa, 0xcb,
+    0x9c, 0x41, 0x45, 0x13, 0x98, 0xab, 0xaa, 0xca, 0xab, 0x40, 0x37, 0x13,
+    0x90, 0xab, 0xba, 0xca, 0xab, 0x38, 0x57, 0x13, 0x80, 0xba, 0xa9, 0xca,
+    0xba, 0x28, 0x47, 0x23, 0x90, 0xb9, 0xaa, 0xba, 0xbc, 0x29, 0x56, 0x33,
+    0x80, 0xaa, 0xab, 0xba, 0xbc, 0x1a, 0x56, 0x33, 0x01, 0xba, 0xab, 0xba,
+    0xbd, 0x09, 0x64, 0x24, 0x01, 0xa9, 0xaa, 0xaa, 0xcb, 0x8a, 0x73, 0x34,
+    0x02, 0xa9, 0xab, 0xaa, 0xdb, 0x8a, 0x62, 0x34, 0x12, 0xa9, 0xba, 0xaa,
+    0xbc, 0x9b, 0x72, 0x44, 0x02, 0xa8, 0xa9, 0xaa, 0xba, 0x9c, 0x41, 0x36,
+    0x13, 0xa0, 0xab, 0xab, 0xcb, 0x9c, 0x40, 0x45, 0x13, 0x98, 0xaa, 0xaa,
+    0xbb, 0xac, 0x48, 0x46, 0x22, 0x90, 0xaa, 0xaa, 0xbb, 0xac, 0x28, 0x47,
+    0x23, 0x80, 0xba, 0xaa, 0xca, 0xbb, 0x28, 0x56, 0x14, 0x81, 0xaa, 0xa9,
+    0xaa, 0xbb, 0x1a, 0x47, 0x24, 0x81, 0xaa, 0x9a, 0xaa, 0xac, 0x0a, 0x64,
+    0x24, 0x81, 0xa9, 0xa9, 0xaa, 0xcb, 0x0a, 0x73, 0x24, 0x02, 0xa9, 0xaa,
+    0xaa, 0xcb, 0x0b, 0x72, 0x34, 0x02, 0xa9, 0xaa, 0xba, 0xcb, 0x8b, 0x62,
+    0x35, 0x03, 0xa8, 0xab, 0xaa, 0xbc, 0x9b, 0x61, 0x45, 0x02, 0xa0, 0xaa,
+    0xa9, 0xca, 0xaa, 0x41, 0x36, 0x23, 0xa8, 0xba, 0xba, 0xcb, 0xbb, 0x50,
+    0x55, 0x22, 0x88, 0xba, 0xa9, 0xba, 0xac, 0x28, 0x47, 0x13, 0x91, 0xaa,
+    0xaa, 0xbb, 0xac, 0x29, 0x47, 0x23, 0x91, 0xaa, 0xba, 0xba, 0xbc, 0x19,
+    0x56, 0x33, 0x81, 0xaa, 0xab, 0xbb, 0xcc, 0x09, 0x45, 0x34, 0x81, 0xa9,
+    0xab, 0xaa, 0xbc, 0x0a, 0x64, 0x34, 0x01, 0xa9, 0xab, 0xaa, 0xcb, 0x0b,
+    0x73, 0x34, 0x02, 0xa9, 0xba, 0xaa, 0xdb, 0x8a, 0x61, 0x44, 0x11, 0x99,
+    0xaa, 0xa9, 0xca, 0x9a, 0x51, 0x35, 0x13, 0xa8, 0xab, 0xab, 0xcb, 0x9c,
+    0x41, 0x45, 0x13, 0xa8, 0xaa, 0xaa, 0xca, 0xab, 0x40, 0x46, 0x13, 0x98,
+    0xb9, 0x9a, 0xbb, 0xac, 0x38, 0x47, 0x23, 0x90, 0xba, 0xaa, 0xba, 0xbc,
+    0x28, 0x47, 0x33, 0x80, 0xab, 0xab, 0xca, 0xbb, 0x29, 0x56, 0x24, 0x80,
+    0xa9, 0xaa, 0xb9, 0xcb, 0x19, 0x64, 0x33, 0x82, 0xaa, 0xbb, 0xba, 0xcc,
+    0x09, 0x73, 0x24, 0x82, 0xa9, 0xaa, 0xb9, 0xcb, 0x8a, 0x54, 0x34, 0x02,
+    0xa9, 0xba, 0xba, 0xdb, 0x8a, 0x62, 0x25, 0x12, 0x99, 0xab, 0xaa, 0xcb,
+    0x9a, 0x61, 0x35, 0x12, 0xa8, 0xba, 0xaa, 0xcb, 0xab, 0x61, 0x35, 0x13,
+    0x98, 0xbb, 0xaa, 0xcb, 0x9c, 0x30, 0x47, 0x12, 0x90, 0xaa, 0x9a, 0xbb,
+    0xbb, 0x48, 0x47, 0x13, 0x90, 0xaa, 0xaa, 0xba, 0xac, 0x39, 0x47, 0x23,
+    0x80, 0xba, 0xaa, 0xbb, 0xbc, 0x29, 0x47, 0x33, 0x91, 0xaa, 0xab, 0xbb,
+    0xbc, 0x1a, 0x56, 0x24, 0x81, 0xa9, 0x9b, 0xaa, 0xac, 0x0a, 0x64, 0x43,
+};
+const Earcon EARCON_THINK = {EARCON_THINK_ADPCM, 1920};
+
+const uint8_t EARCON_PULSE_ADPCM[] = {
+    0x70, 0x77, 0x47, 0x81, 0xa9, 0xba, 0xcc, 0xeb, 0xbc, 0xac, 0x08, 0x64,
+    0x44, 0x23, 0x12, 0xa8, 0xca, 0xab, 0xcb, 0xcb, 0xbc, 0xac, 0x19, 0x54,
+    0x45, 0x32, 0x02, 0x98, 0xba, 0xac, 0xba, 0xca, 0xbc, 0xac, 0x09, 0x73,
+    0x44, 0x32, 0x12, 0x88, 0xbb, 0xcb, 0xaa, 0xbb, 0xcc, 0xab, 0x09, 0x63,
+    0x45, 0x33, 0x12, 0x98, 0xaa, 0xac, 0xaa, 0xba, 0xbc, 0xbc, 0x89, 0x62,
+    0x44, 0x24, 0x12, 0x80, 0xaa, 0xab, 0xab, 0xbb, 0xcc, 0xbb, 0x9a, 0x62,
+    0x54, 0x33, 0x23, 0x80, 0xaa, 0xac, 0xab, 0xba, 0xbc, 0xbc, 0x8b, 0x50,
+    0x54, 0x34, 0x22, 0x00, 0xaa, 0xba, 0xbb, 0xbb, 0xbc, 0xbd, 0x9a, 0x30,
+    0x56, 0x34, 0x22, 0x01, 0xa9, 0xbb, 0xbb, 0xbb, 0xbc, 0xbd, 0x9b, 0x38,
+    0x56, 0x53, 0x22, 0x01, 0x99, 0xba, 0xab, 0xba, 0xcb, 0xbc, 0xab, 0x28,
+    0x65, 0x53, 0x32, 0x01, 0xa8, 0xaa, 0xbb, 0xba, 0xcb, 0xdb, 0x9b, 0x19,
+    0x73, 0x44, 0x32, 0x11, 0x98, 0xba, 0xab, 0xbb, 0xbb, 0xbe, 0xab, 0x09,
+    0x73, 0x35, 0x43, 0x02, 0x90, 0xaa, 0xbb, 0xba, 0xca, 0xcb, 0xbb, 0x8a,
+    0x73, 0x44, 0x43, 0x02, 0x80, 0xaa, 0xba, 0xba, 0xba, 0xcc, 0xbb, 0x99,
+    0x62, 0x54, 0x33, 0x22, 0x80, 0xaa, 0xac, 0xba, 0xaa, 0xbc, 0xbc, 0x9a,
+    0x51, 0x54, 0x24, 0x13, 0x81, 0xb9, 0xba, 0xab, 0xbb, 0xbc, 0xbd, 0x9a,
+    0x40, 0x64, 0x33, 0x14, 0x01, 0xa9, 0xba, 0xab, 0xab, 0xbc, 0xbc, 0xab,
+    0x30, 0x47, 0x34, 0x33, 0x01, 0xa9, 0xbb, 0xac, 0xab, 0xcb, 0xcb, 0xab,
+    0x28, 0x55, 0x35, 0x23, 0x02, 0xa8, 0xbb, 0xcb, 0xaa, 0xca, 0xcb, 0xab,
+    0x18, 0x64, 0x34, 0x24, 0x11, 0x98, 0xba, 0xab, 0xab, 0xcb, 0xbc, 0xbb,
+    0x09, 0x64, 0x44, 0x33, 0x12, 0x98, 0xba, 0xbb, 0xac, 0xba, 0xbc, 0xbc,
+    0x89, 0x63, 0x35, 0x34, 0x12, 0x90, 0xaa, 0xcb, 0xaa, 0xaa, 0xbc, 0xcb,
+    0x0a, 0x51, 0x45, 0x33, 0x23, 0x90, 0xb9, 0xac, 0xab, 0xbb, 0xdb, 0xac,
+    0x8a, 0x41, 0x45, 0x34, 0x22, 0x80, 0xb9, 0xba, 0xbb, 0xbb, 0xbd, 0xbc,
+    0x9a, 0x31, 0x47, 0x34, 0x23, 0x00, 0xa9, 0xcb, 0xaa, 0xaa, 0xcb, 0xac,
+    0x9b, 0x38, 0x56, 0x43, 0x23, 0x81, 0xa8, 0xbb, 0xbb, 0xba, 0xbc, 0xbd,
+    0xaa, 0x28, 0x65, 0x43, 0x23, 0x02, 0x99, 0xbb, 0xbb, 0xbb, 0xdb, 0xbc,
+    0xba, 0x18, 0x55, 0x44, 0x23, 0x11, 0x98, 0xbb, 0xab, 0xbb, 0xcb, 0xbc,
+    0xac, 0x19, 0x63, 0x35, 0x24, 0x12, 0x98, 0xba, 0xba, 0xab, 0xcb, 0xcb,
+    0xac, 0x09, 0x62, 0x44, 0x33, 0x12, 0x88, 0xba, 0xac, 0xaa, 0xab, 0xcc,
+    0xba, 0x8a, 0x53, 0x45, 0x24, 0x22, 0x88, 0xb9, 0xba, 0xab, 0xbb, 0xcc,
+    0xbb, 0x8b, 0x61, 0x54, 0x43, 0x12, 0x80, 0xa9, 0xba, 0xab, 0xba, 0xbc,
+    0xbc, 0x9b, 0x41, 0x46, 0x24, 0x23, 0x81, 0xa9, 0xbb, 0xac, 0xb9, 0xbb,
+    0xbd, 0x9b, 0x30, 0x47, 0x34, 0x32, 0x81, 0xa9, 0xca, 0xaa, 0xaa, 0xcb,
+    0xcb, 0x9b, 0x28, 0x55, 0x44, 0x22, 0x01, 0x98, 0xab, 0xbb, 0xba, 0xcb,
+    0xbc, 0xab, 0x29, 0x65, 0x34, 0x33, 0x02, 0xa8, 0xbb, 0xcb, 0xba, 0xca,
+    0xcb, 0xbb, 0x19, 0x64, 0x44, 0x23, 0x02, 0xa0, 0xaa, 0xbb, 0xbb, 0xcb,
+    0xbc, 0xac, 0x09, 0x63, 0x44, 0x43, 0x11, 0x90, 0xaa, 0xba, 0xaa, 0xbb,
+    0xcc, 0xbb, 0x89, 0x62, 0x45, 0x33, 0x12, 0x80, 0xba, 0xbb, 0xac, 0xba,
+    0xdb, 0xbb, 0x8b, 0x52, 0x36, 0x25, 0x13, 0x80, 0xa9, 0xbb, 0xab, 0xbb,
+};
+const Earcon EARCON_PULSE = {EARCON_PULSE_ADPCM, 960};
+
+#endif // EARCONS_H
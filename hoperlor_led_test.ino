@@ -12,17 +12,12 @@
 #include <driver/i2s.h>
 #include <Adafruit_NeoPixel.h>
 
+#include "audio_pipeline.h" // Pinler, SAMPLE_RATE, I2S kurulumu
+
 // === PIN & LED AYARLARI ===
 #define LED_PIN        48   // ESP32-S3 DevKit dahili RGB LED
 #define LED_COUNT      1
 
-#define I2S_WS_PIN     5
-#define I2S_SCK_PIN    6
-#define I2S_SD_PIN     4
-#define I2S_PORT       I2S_NUM_0
-#define SAMPLE_RATE    16000
-#define BUFFER_LENGTH  512
-
 // === EŞİK DEĞERLERİ (Kalibre edebilirsin) ===
 #define THRESHOLD_SILENT   200    // Altı = sessiz
 #define THRESHOLD_LOUD     2000   // Üstü = yüksek ses
@@ -50,7 +45,7 @@ void loop() {
   size_t bytesRead = 0;
 
   esp_err_t result = i2s_read(
-    I2S_PORT,
+    MIC_PORT,
     &rawBuffer,
     sizeof(rawBuffer),
     &bytesRead,
@@ -62,12 +57,7 @@ void loop() {
   int samplesRead = bytesRead / sizeof(int32_t);
 
   // RMS (Ortalama Ses Seviyesi) hesapla
-  long long sumSquares = 0;
-  for (int i = 0; i < samplesRead; i++) {
-    int32_t sample = rawBuffer[i] >> 14;  // Normalize
-    sumSquares += (long long)sample * sample;
-  }
-  float rms = sqrt((float)sumSquares / samplesRead);
+  float rms = MicAudio::rms(rawBuffer, samplesRead);
 
   // Serial Plotter için yaz
   Serial.println((int)rms);
@@ -96,28 +86,5 @@ void setLED(uint8_t r, uint8_t g, uint8_t b) {
 
 // === I2S BAŞLATMA (öncekiyle aynı) ===
 void i2s_init() {
-  i2s_config_t i2s_config = {
-    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-    .sample_rate = SAMPLE_RATE,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
-    .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-    .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-    .dma_buf_count = 8,
-    .dma_buf_len = BUFFER_LENGTH,
-    .use_apll = false,
-    .tx_desc_auto_clear = false,
-    .fixed_mclk = 0
-  };
-
-  i2s_pin_config_t pin_config = {
-    .bck_io_num   = I2S_SCK_PIN,
-    .ws_io_num    = I2S_WS_PIN,
-    .data_out_num = I2S_PIN_NO_CHANGE,
-    .data_in_num  = I2S_SD_PIN
-  };
-
-  i2s_driver_install(I2S_PORT, &i2s_config, 0, NULL);
-  i2s_set_pin(I2S_PORT, &pin_config);
-  i2s_zero_dma_buffer(I2S_PORT);
+  MicAudio::install(MIC_PORT);
 }
\ No newline at end of file
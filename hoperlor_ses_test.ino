@@ -8,14 +8,8 @@
 #include <driver/i2s.h>
 #include <math.h>
 
-// === PIN TANIMLAMALARI ===
-#define I2S_BCLK_PIN   9    // Bit Clock
-#define I2S_LRC_PIN    10   // Left/Right Clock (WS)
-#define I2S_DIN_PIN    8    // Data Out (ESP32 → Hoparlör)
-
-#define I2S_PORT       I2S_NUM_1   // Mikrofon NUM_0 kullandığı için NUM_1
-#define SAMPLE_RATE    16000
-#define BUFFER_LENGTH  512
+// Pinler (BCLK 9, LRC 10, DIN 8), SPK_PORT (I2S_NUM_1), SAMPLE_RATE
+#include "audio_pipeline.h"
 
 // === BİP SESİ AYARLARI ===
 #define TONE_FREQ      1000   // Hz
@@ -60,7 +54,7 @@ void playTone(int durationMs) {
     int toWrite = min(remaining, BUFFER_LENGTH);
 
     i2s_write(
-      I2S_PORT,
+      SPK_PORT,
       sineBuffer,
       toWrite * sizeof(int16_t),
       &bytesWritten,
@@ -73,34 +67,11 @@ void playTone(int durationMs) {
 
 // === I2S HOPARLÖR BAŞLATMA ===
 void i2s_speaker_init() {
-  i2s_config_t i2s_config = {
-    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),  // Sadece gönderici
-    .sample_rate = SAMPLE_RATE,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-    .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-    .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-    .dma_buf_count = 8,
-    .dma_buf_len = BUFFER_LENGTH,
-    .use_apll = false,
-    .tx_desc_auto_clear = true,   // TX için true (ses kesilmesi önlenir)
-    .fixed_mclk = 0
-  };
-
-  i2s_pin_config_t pin_config = {
-    .bck_io_num   = I2S_BCLK_PIN,
-    .ws_io_num    = I2S_LRC_PIN,
-    .data_out_num = I2S_DIN_PIN,       // TX: hoparlöre gönder
-    .data_in_num  = I2S_PIN_NO_CHANGE  // RX yok
-  };
-
-  esp_err_t err = i2s_driver_install(I2S_PORT, &i2s_config, 0, NULL);
+  // Master + gönderici, 16-bit, TX boşalınca sessizlik (auto clear)
+  esp_err_t err = SpeakerAudio::install(SPK_PORT);
   if (err != ESP_OK) {
     Serial.printf("I2S Speaker HATA: %d\n", err);
     while(1);
   }
-
-  i2s_set_pin(I2S_PORT, &pin_config);
-  i2s_zero_dma_buffer(I2S_PORT);
   Serial.println("I2S Speaker başlatıldı!");
 }
\ No newline at end of file
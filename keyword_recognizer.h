@@ -0,0 +1,369 @@
+#ifndef KEYWORD_RECOGNIZER_H
+#define KEYWORD_RECOGNIZER_H
+
+// ============================================
+//  YEREL KOMUT TANIMA (Fixed-point MFCC + DTW)
+// ============================================
+//  25 ms çerçeve / 10 ms adım, ön vurgu, Hamming, 512 noktalı Q15 FFT
+//  (her katta 1 bit ölçekleme), 24 mel filtresi, tamsayı log2 (Q8) ve
+//  DCT ile 12 kepstrum + log enerji. Sessizlik kırpılır, kepstral ortalama
+//  çıkarılır. Kayıtlı şablonlarla DTW (L1 mesafe) karşılaştırması yapılır.
+//  Kayan nokta sadece tablolar oluşturulurken (kwsInit) kullanılır.
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#define KWS_FRAME 400 // 25 ms @16 kHz
+#define KWS_HOP 160   // 10 ms
+#define KWS_FFT 512
+#define KWS_FFT_BITS 9
+#define KWS_BINS (KWS_FFT / 2 + 1)
+#define KWS_MELS 24
+#define KWS_COEFS 13 // c0 yerine log enerji + c1..c12
+#define KWS_MAX_FRAMES 500 // Kayıt (sessizlik dahil) en fazla 5 sn
+#define KWS_MIN_SPEECH_FRAMES 25 // 250 ms'den kısa konuşma komut değil
+#define KWS_TRIM_DB_Q8 (7 * 256)   // Tepe enerjinin ~21 dB altı sessizlik
+#define KWS_FLOOR_DB_Q8 (3 * 256)  // ...veya gürültü tabanının ~9 dB üstü
+#define KWS_MEL_FLOOR (1ULL << 26) // Zayıf bantlarda gürültüyü bastırır
+#define KWS_PREEMPH_Q15 31785    // 0.97
+
+typedef int16_t KwsVector[KWS_COEFS]; // Q8
+
+struct KwsFeatures {
+  KwsVector frames[KWS_MAX_FRAMES];
+  int count;
+};
+
+struct KwsTables {
+  int16_t window[KWS_FRAME];    // Hamming, Q15
+  int16_t cosT[KWS_FFT / 2];    // Q15
+  int16_t sinT[KWS_FFT / 2];
+  uint16_t bitrev[KWS_FFT];
+  // Her FFT kutusu en fazla iki komşu filtreye düşer: melIndex-1 (azalan
+  // kenar, ağırlık melWeight) ve melIndex (artan kenar, 1 - melWeight)
+  uint8_t melIndex[KWS_BINS]; // 0xFF: filtre aralığı dışında
+  int16_t melWeight[KWS_BINS]; // Q15
+  int16_t dct[KWS_COEFS][KWS_MELS]; // Q15
+};
+
+struct KwsExtractor {
+  int16_t ring[KWS_FRAME]; // Son KWS_FRAME örnek (dairesel)
+  int16_t frame[KWS_FRAME]; // Sıralanmış çerçeve
+  int pos;
+  int fill;
+  int sinceHop;
+  int16_t prevSample;
+  int32_t re[KWS_FFT], im[KWS_FFT];
+};
+
+inline void kwsInit(KwsTables &t) {
+  for (int i = 0; i < KWS_FRAME; i++)
+    t.window[i] = (int16_t)(32767.0f * (0.54f - 0.46f * cosf(2.0f * (float)M_PI *
+                                                               i /
+                                                               (KWS_FRAME - 1))));
+  for (int k = 0; k < KWS_FFT / 2; k++) {
+    t.cosT[k] = (int16_t)(32767.0f * cosf(2.0f * (float)M_PI * k / KWS_FFT));
+    t.sinT[k] = (int16_t)(-32767.0f * sinf(2.0f * (float)M_PI * k / KWS_FFT));
+  }
+  for (int i = 0; i < KWS_FFT; i++) {
+    int r = 0;
+    for (int b = 0; b < KWS_FFT_BITS; b++)
+      if (i & (1 << b))
+        r |= 1 << (KWS_FFT_BITS - 1 - b);
+    t.bitrev[i] = (uint16_t)r;
+  }
+
+  // Mel filtreleri: 100 Hz - 7600 Hz, üçgen, komşu filtreler örtüşür
+  auto hz2mel = [](float f) { return 2595.0f * log10f(1.0f + f / 700.0f); };
+  auto mel2hz = [](float m) { return 700.0f * (powf(10.0f, m / 2595.0f) - 1); };
+  float mLo = hz2mel(100.0f), mHi = hz2mel(7600.0f);
+  float centers[KWS_MELS + 2];
+  for (int m = 0; m < KWS_MELS + 2; m++)
+    centers[m] = mel2hz(mLo + (mHi - mLo) * m / (KWS_MELS + 1)) * KWS_FFT /
+                 16000.0f;
+  for (int b = 0; b < KWS_BINS; b++) {
+    t.melIndex[b] = 0xFF; // Hiçbir filtrede değil
+    t.melWeight[b] = 0;
+    for (int m = 0; m < KWS_MELS + 1; m++) {
+      if (b >= centers[m] && b < centers[m + 1]) {
+        float w = (centers[m + 1] - b) / (centers[m + 1] - centers[m]);
+        t.melIndex[b] = (uint8_t)m;
+        t.melWeight[b] = (int16_t)(w * 32767.0f);
+        break;
+      }
+    }
+  }
+  for (int k = 0; k < KWS_COEFS; k++)
+    for (int m = 0; m < KWS_MELS; m++)
+      t.dct[k][m] = (int16_t)(32767.0f * cosf((float)M_PI * k * (m + 0.5f) /
+                                               KWS_MELS) /
+                              KWS_MELS * 2.0f);
+}
+
+// Tamsayı log2, Q8 (en anlamlı bit + doğrusal kesir)
+inline int32_t kwsLog2Q8(uint64_t x) {
+  if (x == 0)
+    return 0;
+  int msb = 63 - __builtin_clzll(x);
+  uint32_t frac = (msb >= 8) ? (uint32_t)((x >> (msb - 8)) & 0xFF)
+                             : (uint32_t)((x << (8 - msb)) & 0xFF);
+  return (msb << 8) | frac;
+}
+
+inline void kwsFft(const KwsTables &t, int32_t *re, int32_t *im) {
+  for (int i = 0; i < KWS_FFT; i++) {
+    int j = t.bitrev[i];
+    if (j > i) {
+      int32_t tr = re[i], ti = im[i];
+      re[i] = re[j];
+      im[i] = im[j];
+      re[j] = tr;
+      im[j] = ti;
+    }
+  }
+  for (int len = 2; len <= KWS_FFT; len <<= 1) {
+    int half = len >> 1, step = KWS_FFT / len;
+    for (int i = 0; i < KWS_FFT; i += len) {
+      for (int k = 0; k < half; k++) {
+        int32_t wr = t.cosT[k * step], wi = t.sinT[k * step];
+        int a = i + k, b = a + half;
+        int32_t xr = (int32_t)(((int64_t)re[b] * wr - (int64_t)im[b] * wi) >> 15);
+        int32_t xi = (int32_t)(((int64_t)re[b] * wi + (int64_t)im[b] * wr) >> 15);
+        // Her katta /2: taşma yok, toplam ölçek 1/512
+        re[b] = (re[a] - xr) >> 1;
+        im[b] = (im[a] - xi) >> 1;
+        re[a] = (re[a] + xr) >> 1;
+        im[a] = (im[a] + xi) >> 1;
+      }
+    }
+  }
+}
+
+// Tam bir çerçeveden (ex.frame) tek MFCC vektörü
+inline void kwsFrameFeatures(const KwsTables &t, KwsExtractor &ex,
+                             KwsVector out) {
+  uint64_t energy = 0;
+  for (int i = 0; i < KWS_FRAME; i++) {
+    int32_t v = ((int32_t)ex.frame[i] * t.window[i]) >> 7; // Q8 büyütme
+    ex.re[i] = v;
+    ex.im[i] = 0;
+    energy += (uint64_t)((int64_t)ex.frame[i] * ex.frame[i]);
+  }
+  for (int i = KWS_FRAME; i < KWS_FFT; i++)
+    ex.re[i] = ex.im[i] = 0;
+  kwsFft(t, ex.re, ex.im);
+
+  uint64_t mel[KWS_MELS + 1];
+  memset(mel, 0, sizeof(mel));
+  for (int b = 0; b < KWS_BINS; b++) {
+    uint8_t m = t.melIndex[b];
+    if (m == 0xFF)
+      continue;
+    uint64_t p = (uint64_t)((int64_t)ex.re[b] * ex.re[b]) +
+                 (uint64_t)((int64_t)ex.im[b] * ex.im[b]);
+    uint64_t wLo = (uint64_t)t.melWeight[b];
+    if (m > 0)
+      mel[m - 1] += (p >> 15) * wLo;
+    if (m < KWS_MELS)
+      mel[m] += (p >> 15) * (32767 - wLo);
+  }
+  int32_t logMel[KWS_MELS];
+  for (int m = 0; m < KWS_MELS; m++)
+    logMel[m] = kwsLog2Q8(mel[m] + KWS_MEL_FLOOR);
+
+  out[0] = (int16_t)kwsLog2Q8(energy + 1);
+  for (int k = 1; k < KWS_COEFS; k++) {
+    int32_t acc = 0;
+    for (int m = 0; m < KWS_MELS; m++)
+      acc += logMel[m] * t.dct[k][m];
+    out[k] = (int16_t)(acc >> 15);
+  }
+}
+
+inline void kwsBegin(KwsExtractor &ex, KwsFeatures &f) {
+  ex.pos = 0;
+  ex.fill = 0;
+  ex.sinceHop = 0;
+  ex.prevSample = 0;
+  f.count = 0;
+}
+
+// Akış halinde örnek besler; her 10 ms'de bir vektör üretir.
+// false: KWS_MAX_FRAMES aşıldı (komut için fazla uzun)
+inline bool kwsFeed(const KwsTables &t, KwsExtractor &ex, KwsFeatures &f,
+                    const int16_t *pcm, int n) {
+  for (int i = 0; i < n; i++) {
+    int32_t x = pcm[i] - ((KWS_PREEMPH_Q15 * (int32_t)ex.prevSample) >> 15);
+    ex.prevSample = pcm[i];
+    if (x > 32767)
+      x = 32767;
+    if (x < -32768)
+      x = -32768;
+    ex.ring[ex.pos] = (int16_t)x;
+    if (++ex.pos == KWS_FRAME)
+      ex.pos = 0;
+    if (ex.fill < KWS_FRAME)
+      ex.fill++;
+    if (ex.fill == KWS_FRAME && ++ex.sinceHop >= KWS_HOP) {
+      ex.sinceHop = 0;
+      if (f.count >= KWS_MAX_FRAMES)
+        return false;
+      int tail = KWS_FRAME - ex.pos;
+      memcpy(ex.frame, ex.ring + ex.pos, tail * sizeof(int16_t));
+      memcpy(ex.frame + tail, ex.ring, ex.pos * sizeof(int16_t));
+      kwsFrameFeatures(t, ex, f.frames[f.count++]);
+    }
+  }
+  return true;
+}
+
+// Baş/son sessizliği kırpar ve kepstral ortalamayı çıkarır.
+// Dönüş: kalan konuşma çerçevesi sayısı
+inline int kwsFinish(KwsFeatures &f) {
+  if (f.count == 0)
+    return 0;
+  int16_t peak = 0, floor = 0x7FFF;
+  for (int i = 0; i < f.count; i++) {
+    if (f.frames[i][0] > peak)
+      peak = f.frames[i][0];
+    if (f.frames[i][0] < floor)
+      floor = f.frames[i][0];
+  }
+  int32_t thr = peak - KWS_TRIM_DB_Q8;
+  if (floor + KWS_FLOOR_DB_Q8 > thr)
+    thr = floor + KWS_FLOOR_DB_Q8;
+  int first = 0, last = f.count - 1;
+  while (first < last && f.frames[first][0] < thr)
+    first++;
+  while (last > first && f.frames[last][0] < thr)
+    last--;
+  int n = last - first + 1;
+  if (first > 0)
+    memmove(f.frames, f.frames + first, n * sizeof(KwsVector));
+  f.count = n;
+
+  for (int k = 0; k < KWS_COEFS; k++) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++)
+      sum += f.frames[i][k];
+    int16_t mean = (int16_t)(sum / n);
+    for (int i = 0; i < n; i++)
+      f.frames[i][k] -= mean;
+  }
+  return n;
+}
+
+// DTW (L1), yol uzunluğuna göre normalize. row: en az 2*(m+1) int32 alan
+inline int32_t kwsDtw(const KwsVector *a, int n, const KwsVector *b, int m,
+                      int32_t *row) {
+  const int32_t INF = 0x3FFFFFFF;
+  int32_t *prev = row, *cur = row + (m + 1);
+  for (int j = 0; j <= m; j++)
+    prev[j] = INF;
+  prev[0] = 0;
+  for (int i = 1; i <= n; i++) {
+    cur[0] = INF;
+    for (int j = 1; j <= m; j++) {
+      int32_t d = 0;
+      for (int k = 0; k < KWS_COEFS; k++) {
+        int32_t diff = a[i - 1][k] - b[j - 1][k];
+        d += diff < 0 ? -diff : diff;
+      }
+      int32_t best = prev[j - 1];
+      if (prev[j] < best)
+        best = prev[j];
+      if (cur[j - 1] < best)
+        best = cur[j - 1];
+      cur[j] = (best >= INF) ? INF : best + d;
+    }
+    int32_t *tmp = prev;
+    prev = cur;
+    cur = tmp;
+  }
+  return prev[m] / (n + m);
+}
+
+// Tek durumlu çöp (filler) modeli: her çerçevenin ortalama konuşma
+// vektörüne L1 mesafesi. Eşit uzunlukta şablonla DTW ile aynı ölçekte.
+inline int32_t kwsFillerDist(const KwsVector *a, int n, const KwsVector mean) {
+  int64_t sum = 0;
+  for (int i = 0; i < n; i++)
+    for (int k = 0; k < KWS_COEFS; k++) {
+      int32_t diff = a[i][k] - mean[k];
+      sum += diff < 0 ? -diff : diff;
+    }
+  return n > 0 ? (int32_t)(sum / (2 * n)) : 0;
+}
+
+// Kayıtlı şablon: cls aynı komut/cihaz çiftinde aynı olan kimlik
+struct KwsRef {
+  const KwsVector *frames;
+  int count;
+  int cls;
+};
+
+// Kabul eşikleri (cihazda KWS_* ayarları, tools/kws_harness.cpp ile seçilir)
+struct KwsThresholds {
+  int32_t acceptDist; // En yakın şablon mesafesi bunun altında
+  int marginPct;      // ...en yakın başka komutun bu yüzdesinden küçük
+  int fillerPct;      // ...ortalama konuşmaya (çöp) mesafenin bu yüzdesi
+  int minCommands;    // Rakipsiz eşleşme yok: en az bu kadar farklı komut
+};
+
+struct KwsDecision {
+  int best; // refs indeksi, şablon yoksa -1
+  int32_t dist, rival, filler;
+  int commands;
+  bool accept;
+};
+
+// Cihaz ve host düzeneği aynı kararı verir. dist: n adet, row: kwsDtw alanı
+inline KwsDecision kwsDecide(const KwsFeatures &u, const KwsRef *refs, int n,
+                             const KwsThresholds &th, int32_t *dist,
+                             int32_t *row) {
+  KwsDecision d = {-1, INT32_MAX, INT32_MAX, 0, 0, false};
+  for (int i = 0; i < n; i++) {
+    int j = 0;
+    while (j < i && refs[j].cls != refs[i].cls)
+      j++;
+    if (j == i)
+      d.commands++;
+  }
+  // Tek komut öğrenilmişken her ses ona "en yakın" olur: rakip şart
+  if (n == 0 || u.count == 0 || d.commands < th.minCommands)
+    return d;
+
+  d.best = 0;
+  for (int i = 0; i < n; i++) {
+    dist[i] = kwsDtw(u.frames, u.count, refs[i].frames, refs[i].count, row);
+    if (dist[i] < dist[d.best])
+      d.best = i;
+  }
+  d.dist = dist[d.best];
+  // En yakın rakip: başka bir komut/cihaz çiftinin en iyi şablonu
+  for (int i = 0; i < n; i++)
+    if (refs[i].cls != refs[d.best].cls && dist[i] < d.rival)
+      d.rival = dist[i];
+
+  // Çöp modeli: tüm şablon çerçevelerinin ortalaması ("herhangi bir konuşma")
+  int64_t sum[KWS_COEFS] = {0};
+  int64_t frames = 0;
+  for (int i = 0; i < n; i++) {
+    for (int f = 0; f < refs[i].count; f++)
+      for (int k = 0; k < KWS_COEFS; k++)
+        sum[k] += refs[i].frames[f][k];
+    frames += refs[i].count;
+  }
+  KwsVector mean;
+  for (int k = 0; k < KWS_COEFS; k++)
+    mean[k] = (int16_t)(frames > 0 ? sum[k] / frames : 0);
+  d.filler = kwsFillerDist(u.frames, u.count, mean);
+
+  d.accept = d.dist < th.acceptDist &&
+             (int64_t)d.dist * 100 < (int64_t)d.rival * th.marginPct &&
+             (int64_t)d.dist * 100 < (int64_t)d.filler * th.fillerPct;
+  return d;
+}
+
+#endif // KEYWORD_RECOGNIZER_H
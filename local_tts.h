@@ -0,0 +1,347 @@
+#ifndef LOCAL_TTS_H
+#define LOCAL_TTS_H
+
+// ============================================
+//  YEREL TÜRKÇE KONUŞMA SENTEZİ (Formant)
+// ============================================
+//  Türkçe yazıldığı gibi okunur: her harf tek bir sese karşılık gelir, bu
+//  yüzden sözlük gerekmez. Her ses için formant hedefleri (F1-F3), ses
+//  telli/gürültü genlikleri ve süre aşağıdaki tabloda (flash'ta, const).
+//  Kaynak: Rosenberg glottal darbe + beyaz gürültü. Filtre: 3 seri
+//  rezonatör (sesliler/akıcılar) + 1 sürtünme rezonatörü. Formantlar
+//  sesler arasında doğrusal geçer (koartikülasyon).
+//  Kısa onay cümleleri için; kalite bulut TTS değil ama bağlantısız çalışır.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LT_TRANSITION_MS 30 // Formant geçiş süresi
+#define LT_COEF_UPDATE 32   // Rezonatör katsayıları kaç örnekte bir
+#define LT_WORD_GAP_MS 50
+#define LT_PUNCT_GAP_MS 180
+#define LT_F0_START 135.0f // Cümle başı perde (Hz)
+#define LT_F0_END 105.0f   // Cümle sonu (düşen tonlama)
+#define LT_OUTPUT_GAIN 9000.0f
+#define LT_GLOTTAL_TABLE 256 // Örnek başına cosf yerine tablo
+
+typedef enum { LT_VOWEL, LT_SONORANT, LT_FRIC, LT_STOP } LtKind;
+
+struct LtPhone {
+  char key; // Küçük ASCII; ç=C ğ=G ı=I ö=O ş=S ü=U
+  uint8_t kind;
+  uint16_t f1, f2, f3;
+  uint16_t fricHz; // Sürtünme/patlama gürültüsünün merkez frekansı
+  uint8_t voice;   // Ses teli genliği (0-255)
+  uint8_t noise;   // Gürültü genliği (0-255)
+  uint8_t durMs;
+};
+
+static const LtPhone LT_PHONES[] = {
+    // Sesliler
+    {'a', LT_VOWEL, 700, 1220, 2600, 0, 255, 0, 95},
+    {'e', LT_VOWEL, 530, 1840, 2480, 0, 245, 0, 90},
+    {'I', LT_VOWEL, 360, 1400, 2400, 0, 220, 0, 80},
+    {'i', LT_VOWEL, 290, 2250, 2890, 0, 225, 0, 80},
+    {'o', LT_VOWEL, 500, 900, 2400, 0, 250, 0, 95},
+    {'O', LT_VOWEL, 420, 1500, 2300, 0, 235, 0, 90},
+    {'u', LT_VOWEL, 330, 870, 2250, 0, 225, 0, 85},
+    {'U', LT_VOWEL, 300, 1650, 2200, 0, 225, 0, 85},
+    // Akıcılar, genizsiler, yarı sesliler
+    {'l', LT_SONORANT, 360, 1300, 2500, 0, 150, 0, 60},
+    {'r', LT_SONORANT, 420, 1300, 1700, 0, 130, 10, 45},
+    {'m', LT_SONORANT, 280, 1000, 2200, 0, 110, 0, 65},
+    {'n', LT_SONORANT, 280, 1700, 2600, 0, 110, 0, 60},
+    {'y', LT_SONORANT, 280, 2250, 2900, 0, 150, 0, 50},
+    {'G', LT_SONORANT, 0, 0, 0, 0, 0, 0, 70}, // ğ: önceki sesliyi uzatır
+    // Sürtünmeliler
+    {'v', LT_FRIC, 300, 1100, 2300, 1500, 90, 40, 60},
+    {'z', LT_FRIC, 300, 1700, 2600, 5000, 80, 90, 75},
+    {'j', LT_FRIC, 300, 1800, 2500, 2800, 80, 90, 75},
+    {'f', LT_FRIC, 400, 1100, 2300, 1800, 0, 70, 80},
+    {'s', LT_FRIC, 400, 1700, 2600, 5500, 0, 140, 90},
+    {'S', LT_FRIC, 400, 1800, 2500, 2900, 0, 130, 90},
+    {'h', LT_FRIC, 0, 0, 0, 1500, 0, 60, 55}, // Formantlar sonraki sesten
+    // Patlamalılar (kapanma + patlama)
+    {'b', LT_STOP, 250, 900, 2200, 900, 60, 70, 65},
+    {'d', LT_STOP, 250, 1700, 2600, 3500, 60, 80, 60},
+    {'g', LT_STOP, 250, 1900, 2400, 2200, 60, 80, 65},
+    {'p', LT_STOP, 400, 900, 2200, 900, 0, 110, 75},
+    {'t', LT_STOP, 400, 1700, 2600, 4000, 0, 120, 70},
+    {'k', LT_STOP, 400, 1900, 2400, 2500, 0, 120, 75},
+};
+static const int LT_PHONE_COUNT = sizeof(LT_PHONES) / sizeof(LT_PHONES[0]);
+
+static const char *const LT_DIGITS[] = {"sIfIr", "bir",  "iki",   "UC",
+                                        "dOrt",  "beS",  "altI",  "yedi",
+                                        "sekiz", "dokuz"};
+
+inline const LtPhone *ltFind(char key) {
+  for (int i = 0; i < LT_PHONE_COUNT; i++)
+    if (LT_PHONES[i].key == key)
+      return &LT_PHONES[i];
+  return NULL;
+}
+
+// UTF-8 metni iç alfabeye çevirir. Bilinmeyen karakter -> ' ' (duraklama),
+// noktalama -> '.', rakamlar okunuşlarına açılır. Dönüş: yazılan uzunluk.
+inline size_t ltNormalize(const char *in, char *out, size_t outMax) {
+  size_t o = 0;
+  auto put = [&](char c) {
+    if (o + 1 < outMax)
+      out[o++] = c;
+  };
+  for (const uint8_t *p = (const uint8_t *)in; *p; p++) {
+    uint8_t c = *p;
+    if (c == 0xC3 || c == 0xC4 || c == 0xC5) {
+      uint16_t cp = (uint16_t)(c << 8) | p[1];
+      if (p[1] == 0)
+        break;
+      p++;
+      switch (cp) {
+      case 0xC3A7: case 0xC387: put('C'); break; // ç Ç
+      case 0xC49F: case 0xC49E: put('G'); break; // ğ Ğ
+      case 0xC4B1: put('I'); break;              // ı
+      case 0xC4B0: put('i'); break;              // İ
+      case 0xC3B6: case 0xC396: put('O'); break; // ö Ö
+      case 0xC59F: case 0xC59E: put('S'); break; // ş Ş
+      case 0xC3BC: case 0xC39C: put('U'); break; // ü Ü
+      default: put(' '); break;
+      }
+    } else if (c >= '0' && c <= '9') {
+      put(' ');
+      for (const char *d = LT_DIGITS[c - '0']; *d; d++)
+        put(*d);
+      put(' ');
+    } else if (c == 'I') {
+      put('I'); // Türkçede büyük I -> ı
+    } else if (c >= 'A' && c <= 'Z') {
+      put((char)(c + 32));
+    } else if (c >= 'a' && c <= 'z') {
+      put((char)c);
+    } else if (c == '.' || c == ',' || c == '!' || c == '?' || c == ';' ||
+               c == ':') {
+      put('.');
+    } else {
+      put(' ');
+    }
+  }
+  out[o] = '\0';
+  return o;
+}
+
+struct LtResonator {
+  float a, b, c, y1, y2;
+  void set(float f, float bw, float fs) {
+    float r = expf(-(float)M_PI * bw / fs);
+    c = -r * r;
+    b = 2.0f * r * cosf(2.0f * (float)M_PI * f / fs);
+    a = 1.0f - b - c;
+  }
+  float run(float x) {
+    float y = a * x + b * y1 + c * y2;
+    y2 = y1;
+    y1 = y;
+    return y;
+  }
+};
+
+struct LtSynth {
+  float fs;
+  float f1, f2, f3;   // Anlık formantlar
+  float voiceAmp;     // Anlık (yumuşatılmış) genlikler
+  float noiseAmp;
+  float phase;        // Glottal faz (0..1)
+  float prevGlottal;
+  uint32_t rng;
+  LtResonator r1, r2, r3, rf;
+  int16_t *out;
+  size_t pos, maxSamples;
+  size_t totalSamples; // Perde eğrisi için toplam süre
+};
+
+// Rosenberg darbesi (açılma %40, kapanma %16), bir periyot
+static float ltGlottal[LT_GLOTTAL_TABLE];
+static bool ltGlottalReady = false;
+
+inline void ltInitGlottal() {
+  if (ltGlottalReady)
+    return;
+  for (int i = 0; i < LT_GLOTTAL_TABLE; i++) {
+    float ph = (float)i / LT_GLOTTAL_TABLE;
+    if (ph < 0.4f)
+      ltGlottal[i] = 0.5f * (1.0f - cosf((float)M_PI * ph / 0.4f));
+    else if (ph < 0.56f)
+      ltGlottal[i] = cosf((float)M_PI * (ph - 0.4f) / 0.32f);
+    else
+      ltGlottal[i] = 0.0f;
+  }
+  ltGlottalReady = true;
+}
+
+inline float ltNoise(LtSynth &s) {
+  s.rng = s.rng * 1664525u + 1013904223u;
+  return (float)(int32_t)s.rng / 2147483648.0f;
+}
+
+// Tek bir bölüm: formantlar hedefe geçer, genlikler hedefe yumuşar
+inline void ltSegment(LtSynth &s, float tf1, float tf2, float tf3, float fricHz,
+                      float voice, float noise, float durMs) {
+  size_t n = (size_t)(durMs * s.fs / 1000.0f);
+  if (!s.out) { // Sadece uzunluk ölçümü
+    s.pos += n;
+    return;
+  }
+  float sf1 = s.f1, sf2 = s.f2, sf3 = s.f3;
+  size_t trans = (size_t)(LT_TRANSITION_MS * s.fs / 1000.0f);
+  if (trans > n)
+    trans = n;
+  if (fricHz > 0)
+    s.rf.set(fricHz, fricHz * 0.4f, s.fs);
+
+  for (size_t i = 0; i < n && s.pos < s.maxSamples; i++, s.pos++) {
+    if (i % LT_COEF_UPDATE == 0) {
+      float k = trans ? (float)(i < trans ? i : trans) / trans : 1.0f;
+      if (tf1 > 0) {
+        s.f1 = sf1 + (tf1 - sf1) * k;
+        s.f2 = sf2 + (tf2 - sf2) * k;
+        s.f3 = sf3 + (tf3 - sf3) * k;
+      }
+      s.r1.set(s.f1, 70.0f, s.fs);
+      s.r2.set(s.f2, 100.0f, s.fs);
+      s.r3.set(s.f3, 160.0f, s.fs);
+    }
+    // Genlik yumuşatma (~3 ms): tıkırtı olmasın
+    s.voiceAmp += (voice - s.voiceAmp) * 0.02f;
+    s.noiseAmp += (noise - s.noiseAmp) * 0.02f;
+
+    // Düşen tonlama
+    float t = s.totalSamples ? (float)s.pos / s.totalSamples : 0.0f;
+    float f0 = LT_F0_START + (LT_F0_END - LT_F0_START) * t;
+    s.phase += f0 / s.fs;
+    if (s.phase >= 1.0f)
+      s.phase -= 1.0f;
+    // Darbenin türevi = ağız ışıması
+    float g = ltGlottal[(int)(s.phase * LT_GLOTTAL_TABLE)];
+    float glottal = g - s.prevGlottal;
+    s.prevGlottal = g;
+
+    float nz = ltNoise(s);
+    float voiced = s.r3.run(s.r2.run(s.r1.run(glottal * s.voiceAmp * 8.0f)));
+    float fric = (fricHz > 0) ? s.rf.run(nz * s.noiseAmp) : nz * s.noiseAmp;
+    float v = (voiced + fric * 0.35f) * LT_OUTPUT_GAIN;
+    if (v > 32767.0f)
+      v = 32767.0f;
+    if (v < -32768.0f)
+      v = -32768.0f;
+    s.out[s.pos] = (int16_t)v;
+  }
+}
+
+inline void ltSilence(LtSynth &s, float durMs) {
+  ltSegment(s, 0, 0, 0, 0, 0, 0, durMs);
+}
+
+inline void ltRun(LtSynth &s, const char *norm) {
+  const LtPhone *prev = NULL;
+  for (const char *p = norm; *p; p++) {
+    if (*p == ' ') {
+      ltSilence(s, LT_WORD_GAP_MS);
+      prev = NULL;
+      continue;
+    }
+    if (*p == '.') {
+      ltSilence(s, LT_PUNCT_GAP_MS);
+      prev = NULL;
+      continue;
+    }
+    // Birleşik sesler: c = d+j, ç = t+ş
+    if (*p == 'c' || *p == 'C') {
+      const LtPhone *a = ltFind(*p == 'c' ? 'd' : 't');
+      const LtPhone *b = ltFind(*p == 'c' ? 'j' : 'S');
+      ltSilence(s, a->durMs * 0.5f);
+      ltSegment(s, b->f1, b->f2, b->f3, b->fricHz, b->voice / 255.0f,
+                b->noise / 255.0f, b->durMs);
+      prev = b;
+      continue;
+    }
+    const LtPhone *ph = ltFind(*p);
+    if (!ph)
+      continue;
+
+    // Sonraki sesin formantları (h ve patlama geçişleri için)
+    const LtPhone *next = ltFind(p[1]);
+    switch (ph->kind) {
+    case LT_VOWEL:
+    case LT_SONORANT:
+      if (ph->key == 'G') { // ğ: önceki sesliyi uzat
+        if (prev && prev->kind == LT_VOWEL)
+          ltSegment(s, prev->f1, prev->f2, prev->f3, 0, prev->voice / 255.0f,
+                    0, ph->durMs);
+        continue;
+      }
+      ltSegment(s, ph->f1, ph->f2, ph->f3, 0, ph->voice / 255.0f,
+                ph->noise / 255.0f, ph->durMs);
+      break;
+    case LT_FRIC:
+      if (ph->key == 'h' && next && next->f1)
+        ltSegment(s, next->f1, next->f2, next->f3, ph->fricHz, 0,
+                  ph->noise / 255.0f, ph->durMs);
+      else
+        ltSegment(s, ph->f1, ph->f2, ph->f3, ph->fricHz, ph->voice / 255.0f,
+                  ph->noise / 255.0f, ph->durMs);
+      break;
+    case LT_STOP: {
+      // Kapanma: ötümlüde alçak ses çubuğu, ötümsüzde sessizlik
+      ltSegment(s, 250, ph->f2, ph->f3, 0, ph->voice / 255.0f, 0,
+                ph->durMs * 0.6f);
+      // Patlama: gürültü, formantlar sonraki sese doğru
+      const LtPhone *t = (next && next->f1) ? next : ph;
+      ltSegment(s, t->f1, t->f2, t->f3, ph->fricHz, ph->voice / 255.0f,
+                ph->noise / 255.0f, ph->durMs * 0.4f);
+      break;
+    }
+    }
+    prev = ph;
+  }
+  ltSilence(s, 40); // Son kuyruk
+}
+
+inline void ltReset(LtSynth &s, float fs) {
+  ltInitGlottal();
+  s.fs = fs;
+  s.f1 = 500;
+  s.f2 = 1500;
+  s.f3 = 2500;
+  s.voiceAmp = s.noiseAmp = 0;
+  s.phase = 0;
+  s.prevGlottal = 0;
+  s.rng = 12345;
+  s.r1 = s.r2 = s.r3 = s.rf = LtResonator{0, 0, 0, 0, 0};
+  s.pos = 0;
+}
+
+// Normalize edilmiş metnin örnek sayısı (tampon ayırmak için)
+inline size_t localTtsMeasure(const char *norm, float fs) {
+  LtSynth s;
+  ltReset(s, fs);
+  s.out = NULL;
+  s.maxSamples = 0;
+  s.totalSamples = 0;
+  ltRun(s, norm);
+  return s.pos;
+}
+
+// out'a en fazla maxSamples örnek yazar, yazılan örnek sayısını döner
+inline size_t localTtsSynthesize(const char *norm, int16_t *out,
+                                 size_t maxSamples, float fs) {
+  LtSynth s;
+  ltReset(s, fs);
+  s.totalSamples = localTtsMeasure(norm, fs);
+  s.out = out;
+  s.maxSamples = maxSamples;
+  ltRun(s, norm);
+  return s.pos < maxSamples ? s.pos : maxSamples;
+}
+
+#endif // LOCAL_TTS_H
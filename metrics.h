@@ -0,0 +1,126 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+// ============================================
+//  METRİKLER (Prometheus metin formatı)
+// ============================================
+//  Yazma tarafı kilitsiz: sayaçlar __atomic ile artırılır, işlem hattı asla
+//  beklemez. Okuma (scrape) alanları tek tek okur; bir histogramın _sum'ı
+//  ile kovaları arasında en fazla eşzamanlı gözlem kadar fark olabilir.
+//  Süreler ms tutulur, yazarken saniyeye çevrilir (Prometheus birimi).
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#define METRIC_BUCKETS 10
+#define METRIC_HTTP_CODE_SLOTS 8
+
+// Üst sınırlar (ms); son kova +Inf
+static const uint32_t METRIC_BUCKET_MS[METRIC_BUCKETS] = {
+    50, 100, 250, 500, 1000, 2000, 4000, 8000, 16000, 32000};
+
+struct LatencyHistogram {
+  uint32_t buckets[METRIC_BUCKETS + 1]; // Kümülatif değil; _count = toplam
+  uint32_t sumMs;
+};
+
+// Endpoint başına HTTP kodları: yuvalar ilk görülen kodlara CAS ile verilir
+struct HttpCodeCounter {
+  int32_t code[METRIC_HTTP_CODE_SLOTS]; // 0: boş yuva
+  uint32_t count[METRIC_HTTP_CODE_SLOTS];
+  uint32_t other; // Yuvalar dolduktan sonra gelen yeni kodlar
+};
+
+inline void metricInc(uint32_t &counter, uint32_t n = 1) {
+  __atomic_fetch_add(&counter, n, __ATOMIC_RELAXED);
+}
+
+inline uint32_t metricGet(const uint32_t &counter) {
+  return __atomic_load_n(&counter, __ATOMIC_RELAXED);
+}
+
+inline void metricObserve(LatencyHistogram &h, uint32_t ms) {
+  int b = 0;
+  while (b < METRIC_BUCKETS && ms > METRIC_BUCKET_MS[b])
+    b++;
+  metricInc(h.buckets[b]);
+  metricInc(h.sumMs, ms);
+}
+
+// Kova üst sınırından kaba yüzdelik (ms). Az örnek ya da +Inf kovası: 0
+inline uint32_t metricPercentileMs(const LatencyHistogram &h, uint32_t pct,
+                                   uint32_t minSamples) {
+  uint32_t total = 0;
+  for (int b = 0; b <= METRIC_BUCKETS; b++)
+    total += metricGet(h.buckets[b]);
+  if (total == 0 || total < minSamples)
+    return 0;
+  uint32_t need = (total * pct + 99) / 100;
+  uint32_t cumulative = 0;
+  for (int b = 0; b < METRIC_BUCKETS; b++) {
+    cumulative += metricGet(h.buckets[b]);
+    if (cumulative >= need)
+      return METRIC_BUCKET_MS[b];
+  }
+  return 0;
+}
+
+inline void metricHttpCode(HttpCodeCounter &c, int code) {
+  if (code == 0)
+    code = -1000; // 0 boş yuva işareti
+  for (int i = 0; i < METRIC_HTTP_CODE_SLOTS; i++) {
+    int32_t cur = __atomic_load_n(&c.code[i], __ATOMIC_RELAXED);
+    if (cur == 0) {
+      int32_t expected = 0;
+      if (__atomic_compare_exchange_n(&c.code[i], &expected, code, false,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        cur = code;
+      else
+        cur = expected; // Başka görev aldı; aynı kod olabilir
+    }
+    if (cur == code) {
+      metricInc(c.count[i]);
+      return;
+    }
+  }
+  metricInc(c.other);
+}
+
+inline void metricWriteHeader(Print &out, const char *name, const char *type,
+                              const char *help) {
+  out.printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// labels: "stage=\"stt\"" gibi, başlık ayrıca yazılır
+inline void metricWriteHistogram(Print &out, const char *name,
+                                 const char *labels,
+                                 const LatencyHistogram &h) {
+  uint32_t cumulative = 0;
+  for (int b = 0; b < METRIC_BUCKETS; b++) {
+    cumulative += metricGet(h.buckets[b]);
+    out.printf("%s_bucket{%s,le=\"%.3f\"} %u\n", name, labels,
+               METRIC_BUCKET_MS[b] / 1000.0f, cumulative);
+  }
+  cumulative += metricGet(h.buckets[METRIC_BUCKETS]);
+  out.printf("%s_bucket{%s,le=\"+Inf\"} %u\n", name, labels, cumulative);
+  out.printf("%s_sum{%s} %.3f\n", name, labels, metricGet(h.sumMs) / 1000.0f);
+  out.printf("%s_count{%s} %u\n", name, labels, cumulative);
+}
+
+inline void metricWriteHttpCodes(Print &out, const char *name,
+                                 const char *endpoint,
+                                 const HttpCodeCounter &c) {
+  for (int i = 0; i < METRIC_HTTP_CODE_SLOTS; i++) {
+    int32_t code = __atomic_load_n(&c.code[i], __ATOMIC_RELAXED);
+    if (code == 0)
+      break;
+    out.printf("%s{endpoint=\"%s\",code=\"%d\"} %u\n", name, endpoint,
+               code == -1000 ? 0 : code, metricGet(c.count[i]));
+  }
+  uint32_t other = metricGet(c.other);
+  if (other)
+    out.printf("%s{endpoint=\"%s\",code=\"other\"} %u\n", name, endpoint,
+               other);
+}
+
+#endif // METRICS_H
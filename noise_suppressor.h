@@ -0,0 +1,250 @@
+#ifndef NOISE_SUPPRESSOR_H
+#define NOISE_SUPPRESSOR_H
+
+// ============================================
+//  SPEKTRAL GÜRÜLTÜ BASTIRMA (STFT)
+// ============================================
+//  256 örnek çerçeve, 128 örnek adım (%50 örtüşme), kök-Hann pencere ile
+//  analiz + sentez (WOLA). Gürültü spektrumu IDLE'da (kimse konuşmazken)
+//  öğrenilir; LISTENING'de her kutuya Wiener benzeri bir kazanç uygulanır.
+//  Giriş AGC'den sonra gelir: profil birim kazanca indirgenmiş saklanır ve
+//  o anki kazancın karesiyle ölçeklenir (IDLE'daki +30 dB, konuşmada düşen
+//  kazançla karşılaştırılmaz).
+//  Gecikme: bir çerçeve (256 örnek = 16 ms @16 kHz).
+//  Süre sınırlı: 512 örneklik blok = tam olarak 4 FFT + 4 ters FFT.
+//
+//  USE_ESP_DSP tanımlıysa ESP32-S3 için optimize edilmiş esp-dsp FFT'si
+//  kullanılır, değilse taşınabilir radix-2 FFT (host'ta da derlenir).
+
+#include <math.h>
+#include <stdint.h>
+
+#ifdef USE_ESP_DSP
+#include <esp_dsp.h>
+#endif
+
+#define NS_FRAME 256
+#define NS_HOP (NS_FRAME / 2)
+#define NS_BINS (NS_FRAME / 2 + 1)
+
+#define NS_NOISE_ALPHA 0.05f  // IDLE'da gürültü öğrenme hızı
+#define NS_NOISE_DECAY 0.002f // LISTENING'de sadece aşağı doğru takip
+#define NS_OVERSUB 1.5f       // Aşırı çıkarma katsayısı
+#define NS_GAIN_FLOOR 0.12f   // En fazla ~18 dB (müzikal gürültüyü önler)
+#define NS_GAIN_SMOOTH 0.6f   // Zamansal kazanç yumuşatma
+
+struct NoiseSuppressor {
+  float window[NS_FRAME]; // Kök-Hann (periyodik)
+  float inFrame[NS_FRAME];
+  float outAccum[NS_FRAME];
+  float fft[2 * NS_FRAME]; // Karmaşık, iç içe (re, im)
+  float noise[NS_BINS];    // Kutu başına gürültü gücü (birim kazançta)
+  float gain[NS_BINS];
+  int16_t outReady[NS_HOP];
+  int fill;
+  bool primed; // Çerçevenin iki yarısı da sıfırlamadan sonraki örnekler
+  float inputGain; // Girişe uygulanmış (AGC) doğrusal kazanç
+  uint32_t learnedFrames;
+#ifndef USE_ESP_DSP
+  float twiddle[NS_FRAME]; // cos/sin çiftleri (N/2 adet)
+  uint16_t bitrev[NS_FRAME];
+#endif
+  // Ölçüm
+  float inEnergy;  // Son çerçeve enerjisi
+  float outEnergy;
+  uint64_t cycles;
+  uint32_t blocks;
+};
+
+#ifndef USE_ESP_DSP
+// Yerinde, iç içe karmaşık radix-2 FFT
+inline void nsFft(NoiseSuppressor &ns, float *d) {
+  const int n = NS_FRAME;
+  for (int i = 0; i < n; i++) {
+    int j = ns.bitrev[i];
+    if (j > i) {
+      float tr = d[2 * i], ti = d[2 * i + 1];
+      d[2 * i] = d[2 * j];
+      d[2 * i + 1] = d[2 * j + 1];
+      d[2 * j] = tr;
+      d[2 * j + 1] = ti;
+    }
+  }
+  for (int len = 2; len <= n; len <<= 1) {
+    int half = len >> 1;
+    int step = n / len;
+    for (int i = 0; i < n; i += len) {
+      for (int k = 0; k < half; k++) {
+        float wr = ns.twiddle[2 * k * step];
+        float wi = ns.twiddle[2 * k * step + 1];
+        float *a = &d[2 * (i + k)];
+        float *b = &d[2 * (i + k + half)];
+        float xr = b[0] * wr - b[1] * wi;
+        float xi = b[0] * wi + b[1] * wr;
+        b[0] = a[0] - xr;
+        b[1] = a[1] - xi;
+        a[0] += xr;
+        a[1] += xi;
+      }
+    }
+  }
+}
+#else
+inline void nsFft(NoiseSuppressor &ns, float *d) {
+  dsps_fft2r_fc32(d, NS_FRAME);
+  dsps_bit_rev_fc32(d, NS_FRAME);
+}
+#endif
+
+// Çerçeve/örtüşme tamponlarını boşaltır; öğrenilen gürültü profili kalır.
+// Akış kesintiye uğradıysa (ön kayıt yeniden işlenecekse) çağrılır.
+inline void nsResetStream(NoiseSuppressor &ns) {
+  for (int i = 0; i < NS_FRAME; i++) {
+    ns.inFrame[i] = 0;
+    ns.outAccum[i] = 0;
+  }
+  for (int i = 0; i < NS_HOP; i++)
+    ns.outReady[i] = 0;
+  ns.fill = 0;
+  ns.primed = false;
+}
+
+inline void nsInit(NoiseSuppressor &ns) {
+  for (int i = 0; i < NS_FRAME; i++) {
+    // Periyodik Hann'ın karekökü: analiz*sentez = Hann, %50'de toplamı 1
+    float hann = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / NS_FRAME);
+    ns.window[i] = sqrtf(hann);
+    ns.inFrame[i] = 0;
+    ns.outAccum[i] = 0;
+  }
+  for (int k = 0; k < NS_BINS; k++) {
+    ns.noise[k] = 0;
+    ns.gain[k] = 1.0f;
+  }
+  for (int i = 0; i < NS_HOP; i++)
+    ns.outReady[i] = 0;
+  ns.fill = 0;
+  ns.primed = false;
+  ns.inputGain = 1.0f;
+  ns.learnedFrames = 0;
+  ns.inEnergy = ns.outEnergy = 0;
+  ns.cycles = 0;
+  ns.blocks = 0;
+#ifndef USE_ESP_DSP
+  int bits = 0;
+  while ((1 << bits) < NS_FRAME)
+    bits++;
+  for (int i = 0; i < NS_FRAME; i++) {
+    int r = 0;
+    for (int b = 0; b < bits; b++)
+      if (i & (1 << b))
+        r |= 1 << (bits - 1 - b);
+    ns.bitrev[i] = (uint16_t)r;
+  }
+  for (int k = 0; k < NS_FRAME / 2; k++) {
+    ns.twiddle[2 * k] = cosf(-2.0f * (float)M_PI * k / NS_FRAME);
+    ns.twiddle[2 * k + 1] = sinf(-2.0f * (float)M_PI * k / NS_FRAME);
+  }
+#else
+  dsps_fft2r_init_fc32(NULL, NS_FRAME);
+#endif
+}
+
+// Bir adım (NS_HOP yeni örnek) biriktiğinde çağrılır
+inline void nsProcessFrame(NoiseSuppressor &ns, bool learnNoise) {
+  float *d = ns.fft;
+  float eIn = 0;
+  for (int i = 0; i < NS_FRAME; i++) {
+    d[2 * i] = ns.inFrame[i] * ns.window[i];
+    d[2 * i + 1] = 0;
+  }
+  nsFft(ns, d);
+
+  bool haveNoise = ns.learnedFrames > 0;
+  float g2 = ns.inputGain * ns.inputGain;
+  float toUnity = g2 > 0 ? 1.0f / g2 : 1.0f;
+  for (int k = 0; k < NS_BINS; k++) {
+    float re = d[2 * k], im = d[2 * k + 1];
+    float p = re * re + im * im;
+    eIn += p;
+
+    float pu = p * toUnity; // Birim kazançta güç
+    if (learnNoise) {
+      ns.noise[k] += (ns.learnedFrames == 0 ? 1.0f : NS_NOISE_ALPHA) *
+                     (pu - ns.noise[k]);
+    } else if (pu < ns.noise[k]) {
+      ns.noise[k] += NS_NOISE_DECAY * (pu - ns.noise[k]);
+    }
+
+    float g = 1.0f;
+    if (haveNoise && !learnNoise) {
+      g = (pu > 0) ? 1.0f - NS_OVERSUB * ns.noise[k] / pu : NS_GAIN_FLOOR;
+      if (g < NS_GAIN_FLOOR)
+        g = NS_GAIN_FLOOR;
+      g = NS_GAIN_SMOOTH * ns.gain[k] + (1.0f - NS_GAIN_SMOOTH) * g;
+    }
+    ns.gain[k] = g;
+  }
+  if (learnNoise)
+    ns.learnedFrames++;
+
+  // Kazanç uygula (gerçek sinyal: k ve N-k simetrik) + ters FFT için eşlenik
+  float eOut = 0;
+  for (int k = 0; k < NS_FRAME; k++) {
+    int b = (k < NS_BINS) ? k : NS_FRAME - k;
+    float g = ns.gain[b];
+    d[2 * k] *= g;
+    d[2 * k + 1] = -d[2 * k + 1] * g;
+    if (k < NS_BINS)
+      eOut += d[2 * k] * d[2 * k] + d[2 * k + 1] * d[2 * k + 1];
+  }
+  nsFft(ns, d); // conj(FFT(conj(X))) / N = IFFT(X); gerçel kısım yeterli
+
+  const float scale = 1.0f / NS_FRAME;
+  for (int i = 0; i < NS_FRAME; i++)
+    ns.outAccum[i] += d[2 * i] * scale * ns.window[i];
+
+  for (int i = 0; i < NS_HOP; i++) {
+    float v = ns.outAccum[i];
+    if (v > 32767.0f)
+      v = 32767.0f;
+    if (v < -32768.0f)
+      v = -32768.0f;
+    ns.outReady[i] = (int16_t)v;
+  }
+  for (int i = 0; i < NS_HOP; i++) {
+    ns.outAccum[i] = ns.outAccum[i + NS_HOP];
+    ns.outAccum[i + NS_HOP] = 0;
+    ns.inFrame[i] = ns.inFrame[i + NS_HOP];
+  }
+  ns.inEnergy = eIn;
+  ns.outEnergy = eOut;
+}
+
+// Akış halinde işler; in ve out aynı tampon olabilir. Çıkış NS_FRAME gecikmeli.
+// learnNoise: sadece konuşma yokken (IDLE, eşiğin altında) true verilmeli.
+// inputGain: bu bloğa önceden uygulanmış doğrusal kazanç (AGC; yoksa 1).
+inline void nsProcess(NoiseSuppressor &ns, const int16_t *in, int16_t *out,
+                      int n, bool learnNoise, float inputGain = 1.0f) {
+  ns.inputGain = inputGain;
+  for (int i = 0; i < n; i++) {
+    int16_t x = in[i];
+    out[i] = ns.outReady[ns.fill];
+    ns.inFrame[NS_HOP + ns.fill] = x;
+    if (++ns.fill == NS_HOP) {
+      ns.fill = 0;
+      // Yarısı sıfır olan ilk çerçeve gürültü profiline katılmaz
+      nsProcessFrame(ns, learnNoise && ns.primed);
+      ns.primed = true;
+    }
+  }
+}
+
+// Son çerçevede bastırılan enerji (dB)
+inline float nsAttenuationDb(const NoiseSuppressor &ns) {
+  if (ns.outEnergy <= 0 || ns.inEnergy <= 0)
+    return 0.0f;
+  return 10.0f * log10f(ns.inEnergy / ns.outEnergy);
+}
+
+#endif // NOISE_SUPPRESSOR_H
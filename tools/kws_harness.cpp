@@ -0,0 +1,477 @@
+// ============================================
+//  YEREL KOMUT TANIMA — HOST TEST DÜZENEĞİ
+// ============================================
+//  keyword_recognizer.h'ı PC'de bir derlem üzerinde çalıştırır: doğruluk,
+//  yanlış komut, çöp (komut olmayan konuşma) yanlış kabulü ve ifade başına
+//  MFCC/DTW süresi. Karar cihazdakiyle aynı fonksiyondur (kwsDecide).
+//
+//  Derlem düzeni: DIR/<komut>/*.wav. Her komutun ada göre ilk -t dosyası
+//  şablon olarak öğrenilir (cihazda bulutun ilk iki eylem kaydı), kalanlar
+//  test edilir. '_' ile başlayan klasörler (ör. _cop) komut değildir ve
+//  reddedilmelidir. Kayıtlar cihazdaki gibi olmalı: ~0.5 sn ön kayıt +
+//  konuşma + 1.5 sn sessizlik, en fazla 5 sn.
+//
+//  Derleme (depo kökünden):
+//    g++ -O2 -std=gnu++11 -I. tools/kws_harness.cpp -o kws_harness
+//  Kullanım:
+//    ./kws_harness [-t 2] [-d 400] [-m 65] [-f 70] [-s] DIR
+//    ./kws_harness --synth DIR   (local_tts.h ile sentetik derlem üretir)
+//  WAV: 16-bit PCM, mono, 16 kHz. -s: eşik taraması; yanlış kabulü sıfır
+//  olan ayarlar doğruluğa göre sıralanır.
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "keyword_recognizer.h"
+#include "local_tts.h"
+
+#define KWS_RATE 16000
+#define KWS_TEMPLATE_MAX_FRAMES 200 // delican.cpp ile aynı
+#define KWS_MAX_TEMPLATES 16
+#define KWS_LEAD_MS 500   // Cihazdaki PRE_ROLL_MS
+#define KWS_TAIL_MS 1500  // Cihazdaki SILENCE_TIMEOUT_MS
+
+static bool readWav(const char *path, std::vector<int16_t> &out) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "%s: açılamadı\n", path);
+    return false;
+  }
+  char riff[12];
+  if (fread(riff, 1, 12, f) != 12 || memcmp(riff, "RIFF", 4) ||
+      memcmp(riff + 8, "WAVE", 4)) {
+    fprintf(stderr, "%s: WAV değil\n", path);
+    fclose(f);
+    return false;
+  }
+  bool fmtOk = false;
+  for (;;) {
+    char id[4];
+    uint32_t size;
+    if (fread(id, 1, 4, f) != 4 || fread(&size, 4, 1, f) != 1)
+      break;
+    if (!memcmp(id, "fmt ", 4)) {
+      uint8_t fmt[16];
+      if (size < 16 || fread(fmt, 1, 16, f) != 16)
+        break;
+      uint16_t format = fmt[0] | fmt[1] << 8;
+      uint16_t channels = fmt[2] | fmt[3] << 8;
+      uint32_t rate = fmt[4] | fmt[5] << 8 | fmt[6] << 16 | (uint32_t)fmt[7] << 24;
+      uint16_t bits = fmt[14] | fmt[15] << 8;
+      fmtOk = format == 1 && channels == 1 && bits == 16;
+      if (!fmtOk)
+        fprintf(stderr, "%s: 16-bit mono PCM olmalı\n", path);
+      if (rate != KWS_RATE)
+        fprintf(stderr, "%s: uyarı: %u Hz (16000 bekleniyor)\n", path, rate);
+      fseek(f, size - 16 + (size & 1), SEEK_CUR);
+    } else if (!memcmp(id, "data", 4)) {
+      if (!fmtOk)
+        break;
+      out.resize(size / 2);
+      size_t n = fread(out.data(), 2, out.size(), f);
+      out.resize(n);
+      fclose(f);
+      return n > 0;
+    } else {
+      fseek(f, size + (size & 1), SEEK_CUR);
+    }
+  }
+  fprintf(stderr, "%s: data bölümü yok\n", path);
+  fclose(f);
+  return false;
+}
+
+static bool writeWav(const std::string &path, const std::vector<int16_t> &pcm) {
+  FILE *f = fopen(path.c_str(), "wb");
+  if (!f)
+    return false;
+  uint32_t data = (uint32_t)pcm.size() * 2, riff = 36 + data;
+  uint32_t rate = KWS_RATE, byteRate = KWS_RATE * 2, fmtSize = 16;
+  uint16_t format = 1, channels = 1, align = 2, bits = 16;
+  fwrite("RIFF", 1, 4, f);
+  fwrite(&riff, 4, 1, f);
+  fwrite("WAVEfmt ", 1, 8, f);
+  fwrite(&fmtSize, 4, 1, f);
+  fwrite(&format, 2, 1, f);
+  fwrite(&channels, 2, 1, f);
+  fwrite(&rate, 4, 1, f);
+  fwrite(&byteRate, 4, 1, f);
+  fwrite(&align, 2, 1, f);
+  fwrite(&bits, 2, 1, f);
+  fwrite("data", 1, 4, f);
+  fwrite(&data, 4, 1, f);
+  fwrite(pcm.data(), 2, pcm.size(), f);
+  return fclose(f) == 0;
+}
+
+static std::vector<std::string> listDir(const std::string &dir, bool dirs) {
+  std::vector<std::string> names;
+  DIR *d = opendir(dir.c_str());
+  if (!d)
+    return names;
+  while (struct dirent *e = readdir(d)) {
+    if (e->d_name[0] == '.')
+      continue;
+    std::string path = dir + "/" + e->d_name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || S_ISDIR(st.st_mode) != dirs)
+      continue;
+    if (!dirs && (path.size() < 4 || path.compare(path.size() - 4, 4, ".wav")))
+      continue;
+    names.push_back(e->d_name);
+  }
+  closedir(d);
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+// ============================================
+//  ÖZNİTELİK ÇIKARMA (cihazdaki kwsExtractRecording)
+// ============================================
+static KwsTables tables;
+static KwsExtractor extractor;
+
+struct Utterance {
+  std::string name;
+  int cls; // Komut indeksi, çöp için -1
+  std::vector<int16_t> frames; // count * KWS_COEFS
+  int count;
+  bool valid;
+  double featureUs, audioMs;
+};
+
+static bool extract(const std::vector<int16_t> &pcm, Utterance &u) {
+  static KwsFeatures f; // ~13 KB
+  u.audioMs = pcm.size() * 1000.0 / KWS_RATE;
+  auto t0 = std::chrono::steady_clock::now();
+  kwsBegin(extractor, f);
+  bool ok = pcm.size() <= (size_t)KWS_MAX_FRAMES * KWS_HOP;
+  for (size_t i = 0; ok && i < pcm.size(); i += 256) {
+    int n = (int)std::min((size_t)256, pcm.size() - i);
+    ok = kwsFeed(tables, extractor, f, &pcm[i], n);
+  }
+  int frames = ok ? kwsFinish(f) : 0;
+  u.featureUs = std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - t0)
+                    .count();
+  u.valid = frames >= KWS_MIN_SPEECH_FRAMES && frames <= KWS_TEMPLATE_MAX_FRAMES;
+  u.count = u.valid ? frames : 0;
+  u.frames.assign(&f.frames[0][0], &f.frames[0][0] + u.count * KWS_COEFS);
+  return u.valid;
+}
+
+static const KwsVector *vectors(const Utterance &u) {
+  return (const KwsVector *)u.frames.data();
+}
+
+// ============================================
+//  DEĞERLENDİRME
+// ============================================
+struct Trial {
+  const Utterance *u;
+  KwsDecision d; // Eşikten bağımsız alanlar: best, dist, rival, filler
+  int bestCls;
+  double dtwUs;
+};
+
+struct Score {
+  int commands, correct, wrong, fillers, falseAccepts;
+};
+
+static bool accepts(const Trial &t, const KwsThresholds &th) {
+  const KwsDecision &d = t.d;
+  return d.best >= 0 && d.commands >= th.minCommands &&
+         d.dist < th.acceptDist &&
+         (int64_t)d.dist * 100 < (int64_t)d.rival * th.marginPct &&
+         (int64_t)d.dist * 100 < (int64_t)d.filler * th.fillerPct;
+}
+
+static Score score(const std::vector<Trial> &trials, const KwsThresholds &th) {
+  Score s = {0, 0, 0, 0, 0};
+  for (const Trial &t : trials) {
+    bool ok = accepts(t, th);
+    if (t.u->cls < 0) {
+      s.fillers++;
+      s.falseAccepts += ok;
+    } else {
+      s.commands++;
+      s.correct += ok && t.bestCls == t.u->cls;
+      s.wrong += ok && t.bestCls != t.u->cls;
+    }
+  }
+  return s;
+}
+
+static double pct(int a, int b) { return b > 0 ? 100.0 * a / b : 0; }
+
+static int evaluate(const char *root, int perCommand, KwsThresholds th,
+                    bool sweep) {
+  std::vector<std::string> classes = listDir(root, true);
+  std::vector<Utterance> refs, tests;
+  std::vector<std::string> names;
+  for (const std::string &c : classes) {
+    bool filler = c[0] == '_';
+    int cls = filler ? -1 : (int)names.size();
+    if (!filler)
+      names.push_back(c);
+    int enrolled = 0;
+    for (const std::string &file : listDir(std::string(root) + "/" + c, false)) {
+      std::string path = std::string(root) + "/" + c + "/" + file;
+      std::vector<int16_t> pcm;
+      if (!readWav(path.c_str(), pcm))
+        continue;
+      Utterance u;
+      u.name = c + "/" + file;
+      u.cls = cls;
+      extract(pcm, u);
+      if (!filler && enrolled < perCommand) {
+        // Cihaz sadece geçerli (kırpılmış uzunluğu uygun) kaydı öğrenir
+        if (u.valid) {
+          refs.push_back(u);
+          enrolled++;
+        }
+        continue;
+      }
+      tests.push_back(u);
+    }
+  }
+  if (refs.size() > KWS_MAX_TEMPLATES)
+    fprintf(stderr, "uyarı: %zu şablon (cihazda en fazla %d)\n", refs.size(),
+            KWS_MAX_TEMPLATES);
+  if (refs.empty() || tests.empty()) {
+    fprintf(stderr, "%s: şablon ya da test kaydı yok\n", root);
+    return 1;
+  }
+
+  std::vector<KwsRef> kref;
+  for (const Utterance &r : refs)
+    kref.push_back(KwsRef{vectors(r), r.count, r.cls});
+  std::vector<int32_t> dist(refs.size());
+  std::vector<int32_t> row(2 * (KWS_TEMPLATE_MAX_FRAMES + 1));
+  static KwsFeatures f;
+
+  // Eşikten bağımsız mesafeler bir kez hesaplanır, tarama bunları kullanır
+  std::vector<Trial> trials;
+  double featureUs = 0, dtwUs = 0, maxUs = 0, audioMs = 0;
+  int invalid = 0;
+  for (const Utterance &u : tests) {
+    Trial t;
+    t.u = &u;
+    memcpy(f.frames, u.frames.data(), u.frames.size() * sizeof(int16_t));
+    f.count = u.count;
+    auto t0 = std::chrono::steady_clock::now();
+    t.d = kwsDecide(f, kref.data(), (int)kref.size(), th, dist.data(),
+                    row.data());
+    t.dtwUs = std::chrono::duration<double, std::micro>(
+                  std::chrono::steady_clock::now() - t0)
+                  .count();
+    t.bestCls = t.d.best >= 0 ? refs[t.d.best].cls : -1;
+    trials.push_back(t);
+    featureUs += u.featureUs;
+    dtwUs += t.dtwUs;
+    maxUs = std::max(maxUs, u.featureUs + t.dtwUs);
+    audioMs += u.audioMs;
+    invalid += !u.valid;
+  }
+
+  printf("%zu komut, %zu şablon, %zu test (%d geçersiz uzunluk -> bulut)\n",
+         names.size(), refs.size(), tests.size(), invalid);
+  if (!sweep) {
+    printf("%-36s %-14s %7s %7s %7s  %s\n", "dosya", "en yakın", "mesafe",
+           "rakip", "çöp", "karar");
+    for (const Trial &t : trials) {
+      bool ok = accepts(t, th);
+      const char *verdict = !ok ? "bulut"
+                            : t.u->cls < 0 ? "YANLIŞ KABUL"
+                            : t.bestCls == t.u->cls ? "doğru"
+                                                    : "YANLIŞ KOMUT";
+      printf("%-36s %-14s %7d %7d %7d  %s\n", t.u->name.c_str(),
+             t.bestCls >= 0 ? names[t.bestCls].c_str() : "-",
+             t.d.best >= 0 ? (int)t.d.dist : -1,
+             t.d.rival == INT32_MAX ? -1 : (int)t.d.rival, (int)t.d.filler,
+             verdict);
+    }
+  }
+
+  Score s = score(trials, th);
+  printf("Eşik -d %d -m %d -f %d: doğruluk %%%.1f (%d/%d), yanlış komut "
+         "%%%.1f, çöp yanlış kabul %%%.1f (%d/%d)\n",
+         (int)th.acceptDist, th.marginPct, th.fillerPct,
+         pct(s.correct, s.commands), s.correct, s.commands,
+         pct(s.wrong, s.commands), pct(s.falseAccepts, s.fillers),
+         s.falseAccepts, s.fillers);
+  size_t n = trials.size();
+  printf("İfade başına: MFCC %.0f us + DTW %.0f us (en kötü %.0f us), ses "
+         "%.0f ms; gerçek zamanın %%%.2f'i (bu makinede)\n",
+         featureUs / n, dtwUs / n, maxUs, audioMs / n,
+         100.0 * (featureUs + dtwUs) / (audioMs * 1000));
+
+  if (sweep) {
+    struct Row {
+      KwsThresholds th;
+      Score s;
+    };
+    std::vector<Row> rows;
+    for (int d = 200; d <= 1200; d += 50)
+      for (int m = 60; m <= 95; m += 5)
+        for (int fl = 40; fl <= 100; fl += 5) {
+          KwsThresholds t = {d, m, fl, th.minCommands};
+          Score sc = score(trials, t);
+          if (sc.falseAccepts == 0 && sc.wrong == 0)
+            rows.push_back(Row{t, sc});
+        }
+    // En çok doğru; eşitlikte en sıkı (küçük) eşikler
+    std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
+      if (a.s.correct != b.s.correct)
+        return a.s.correct > b.s.correct;
+      int sa = a.th.acceptDist / 10 + a.th.marginPct + a.th.fillerPct;
+      int sb = b.th.acceptDist / 10 + b.th.marginPct + b.th.fillerPct;
+      return sa < sb;
+    });
+    printf("Yanlış kabulsüz ayarlar (ilk 10):\n%6s %4s %4s %9s\n", "-d", "-m",
+           "-f", "doğruluk");
+    for (size_t i = 0; i < rows.size() && i < 10; i++)
+      printf("%6d %4d %4d %8.1f%%\n", (int)rows[i].th.acceptDist,
+             rows[i].th.marginPct, rows[i].th.fillerPct,
+             pct(rows[i].s.correct, rows[i].s.commands));
+    if (rows.empty())
+      printf("(yok: hiçbir ayarda yanlış kabul sıfır değil)\n");
+  }
+  return 0;
+}
+
+// ============================================
+//  SENTETİK DERLEM (local_tts.h)
+// ============================================
+//  Gerçek kayıt yerine geçmez; eşiklerin kaba ayarı ve gerileme testi için.
+//  Hız/perde çeşitlemesi: fs' ile sentezlenip 16 kHz diye yazılır.
+struct SynthPhrase {
+  const char *dir;
+  const char *text;
+};
+
+static const SynthPhrase SYNTH_COMMANDS[] = {
+    {"salon_ac", "salon ışığını aç"},
+    {"salon_kapat", "salon ışığını kapat"},
+    {"mutfak_ac", "mutfak ışığını aç"},
+    {"mutfak_kapat", "mutfak ışığını kapat"},
+    {"tv_ac", "televizyonu aç"},
+    {"tv_kapat", "televizyonu kapat"},
+};
+
+static const char *const SYNTH_FILLERS[] = {
+    "bugün hava nasıl",     "saat kaç",           "bir şarkı çal",
+    "salon ışığı açık mı",  "yarın beni uyandır", "mutfakta ne var",
+    "televizyonda ne var",  "kapıyı kim çaldı",   "ışıklar yanıyor mu",
+    "annemi ara",
+};
+
+static const float SYNTH_RATES[] = {1.00f, 0.97f, 1.04f, 0.92f, 1.08f, 0.95f};
+static const float SYNTH_SNRS[] = {30, 20, 10};
+
+static uint32_t synthRng = 1;
+
+static float synthNoise() {
+  synthRng = synthRng * 1664525u + 1013904223u;
+  return (int32_t)synthRng / 2147483648.0f;
+}
+
+static bool synthOne(const std::string &path, const char *text, float rate,
+                     float snrDb) {
+  char norm[256];
+  ltNormalize(text, norm, sizeof(norm));
+  float fs = KWS_RATE * rate;
+  std::vector<int16_t> speech(localTtsMeasure(norm, fs));
+  speech.resize(localTtsSynthesize(norm, speech.data(), speech.size(), fs));
+
+  double power = 0;
+  for (int16_t v : speech)
+    power += (double)v * v;
+  power /= std::max((size_t)1, speech.size());
+  // Alçak geçiren (pembemsi) gürültü, konuşmaya göre istenen SNR'de
+  float level = (float)sqrt(power / pow(10.0, snrDb / 10) * 3);
+  size_t lead = KWS_RATE * KWS_LEAD_MS / 1000;
+  size_t tail = KWS_RATE * KWS_TAIL_MS / 1000;
+  std::vector<int16_t> pcm(lead + speech.size() + tail);
+  float lp = 0;
+  for (size_t i = 0; i < pcm.size(); i++) {
+    lp += 0.3f * (synthNoise() - lp);
+    float s = (i >= lead && i - lead < speech.size()) ? speech[i - lead] : 0;
+    float v = s + level * lp * 1.7f;
+    pcm[i] = (int16_t)std::max(-32768.0f, std::min(32767.0f, v));
+  }
+  return writeWav(path, pcm);
+}
+
+static int synthesize(const char *root) {
+  mkdir(root, 0755);
+  int files = 0;
+  char name[64];
+  for (const SynthPhrase &p : SYNTH_COMMANDS) {
+    std::string dir = std::string(root) + "/" + p.dir;
+    mkdir(dir.c_str(), 0755);
+    // 00, 01: temiz şablonlar; kalanlar hız x SNR çeşitlemeleri
+    int k = 0;
+    for (float rate : SYNTH_RATES)
+      for (float snr : SYNTH_SNRS) {
+        if (k < 2 && snr != SYNTH_SNRS[0])
+          continue;
+        snprintf(name, sizeof(name), "/%02d_r%03d_s%02d.wav", k++,
+                 (int)lrintf(rate * 100), (int)snr);
+        files += synthOne(dir + name, p.text, rate, snr);
+      }
+  }
+  std::string dir = std::string(root) + "/_cop";
+  mkdir(dir.c_str(), 0755);
+  int k = 0;
+  for (const char *text : SYNTH_FILLERS)
+    for (int v = 0; v < 3; v++) {
+      snprintf(name, sizeof(name), "/%02d.wav", k++);
+      files += synthOne(dir + name, text, SYNTH_RATES[v * 2],
+                        SYNTH_SNRS[v]);
+    }
+  printf("%s: %d dosya yazıldı\n", root, files);
+  return files > 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+  if (argc == 3 && !strcmp(argv[1], "--synth"))
+    return synthesize(argv[2]);
+
+  // Varsayılanlar delican.cpp'deki KWS_* ayarlarıdır
+  KwsThresholds th = {400, 65, 70, 2};
+  int perCommand = 2;
+  bool sweep = false;
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-'; arg++) {
+    if (!strcmp(argv[arg], "-t") && arg + 1 < argc)
+      perCommand = atoi(argv[++arg]);
+    else if (!strcmp(argv[arg], "-d") && arg + 1 < argc)
+      th.acceptDist = atoi(argv[++arg]);
+    else if (!strcmp(argv[arg], "-m") && arg + 1 < argc)
+      th.marginPct = atoi(argv[++arg]);
+    else if (!strcmp(argv[arg], "-f") && arg + 1 < argc)
+      th.fillerPct = atoi(argv[++arg]);
+    else if (!strcmp(argv[arg], "-s"))
+      sweep = true;
+    else
+      break;
+  }
+  if (argc - arg != 1) {
+    fprintf(stderr, "Kullanım: %s [-t 2] [-d 400] [-m 65] [-f 70] [-s] DIR\n"
+                    "          %s --synth DIR\n",
+            argv[0], argv[0]);
+    return 2;
+  }
+  kwsInit(tables);
+  return evaluate(argv[arg], perCommand, th, sweep);
+}
@@ -0,0 +1,221 @@
+// ============================================
+//  GÜRÜLTÜ BASTIRMA — HOST TEST DÜZENEĞİ
+// ============================================
+//  noise_suppressor.h'ı PC'de çalıştırır: işlem maliyeti ve SNR kazancı.
+//  Her temiz konuşma dosyası, gürültü dosyasıyla istenen SNR'lerde
+//  karıştırılır. Önce NS_LEAD_MS kadar sadece gürültü verilir (cihazdaki
+//  IDLE: profil öğrenilir), sonra karışım (LISTENING). SNR, temiz sinyale
+//  göre hizalanmış çıkıştan ölçülür (kalan gürültü + bozulma = hata).
+//
+//  Derleme (depo kökünden):
+//    g++ -O2 -std=gnu++11 -I. tools/ns_harness.cpp -o ns_harness
+//  Kullanım:
+//    ./ns_harness [-s 0,5,10] [-g 20] gurultu.wav konusma1.wav ...
+//  WAV: 16-bit PCM, mono, 16 kHz. -g: öğrenme sırasında girişe dB kadar
+//  fazla kazanç uygulanır (cihazdaki IDLE AGC'si), konuşmada 0 dB.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "noise_suppressor.h"
+
+#define NS_LEAD_MS 1500
+#define NS_BLOCK 512 // Cihazdaki okuma bloğu (BUFFER_LENGTH)
+#define NS_RATE 16000
+
+static bool readWav(const char *path, std::vector<float> &out) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "%s: açılamadı\n", path);
+    return false;
+  }
+  char riff[12];
+  if (fread(riff, 1, 12, f) != 12 || memcmp(riff, "RIFF", 4) ||
+      memcmp(riff + 8, "WAVE", 4)) {
+    fprintf(stderr, "%s: WAV değil\n", path);
+    fclose(f);
+    return false;
+  }
+  bool fmtOk = false;
+  for (;;) {
+    char id[4];
+    uint32_t size;
+    if (fread(id, 1, 4, f) != 4 || fread(&size, 4, 1, f) != 1)
+      break;
+    if (!memcmp(id, "fmt ", 4)) {
+      uint8_t fmt[16];
+      if (size < 16 || fread(fmt, 1, 16, f) != 16)
+        break;
+      uint16_t format = fmt[0] | fmt[1] << 8;
+      uint16_t channels = fmt[2] | fmt[3] << 8;
+      uint32_t rate = fmt[4] | fmt[5] << 8 | fmt[6] << 16 | (uint32_t)fmt[7] << 24;
+      uint16_t bits = fmt[14] | fmt[15] << 8;
+      fmtOk = format == 1 && channels == 1 && bits == 16;
+      if (!fmtOk)
+        fprintf(stderr, "%s: 16-bit mono PCM olmalı\n", path);
+      if (rate != NS_RATE)
+        fprintf(stderr, "%s: uyarı: %u Hz (16000 bekleniyor)\n", path, rate);
+      fseek(f, size - 16 + (size & 1), SEEK_CUR);
+    } else if (!memcmp(id, "data", 4)) {
+      if (!fmtOk)
+        break;
+      std::vector<int16_t> pcm(size / 2);
+      size_t n = fread(pcm.data(), 2, pcm.size(), f);
+      out.assign(pcm.begin(), pcm.begin() + n);
+      fclose(f);
+      return n > 0;
+    } else {
+      fseek(f, size + (size & 1), SEEK_CUR);
+    }
+  }
+  fprintf(stderr, "%s: data bölümü yok\n", path);
+  fclose(f);
+  return false;
+}
+
+static double energy(const std::vector<float> &x, size_t from, size_t n) {
+  double e = 0;
+  for (size_t i = from; i < from + n && i < x.size(); i++)
+    e += (double)x[i] * x[i];
+  return e;
+}
+
+static int16_t clip16(float v) {
+  if (v > 32767.0f)
+    return 32767;
+  if (v < -32768.0f)
+    return -32768;
+  return (int16_t)lrintf(v);
+}
+
+// Profil yokken bastırıcı birim kazançlı bir gecikme hattıdır: dürtüyle ölç
+static int measureDelay(NoiseSuppressor &ns) {
+  nsInit(ns);
+  std::vector<int16_t> in(4 * NS_FRAME, 0), out(in.size());
+  in[0] = 10000;
+  nsProcess(ns, in.data(), out.data(), (int)in.size(), false);
+  int best = 0;
+  for (int i = 1; i < (int)out.size(); i++)
+    if (std::abs(out[i]) > std::abs(out[best]))
+      best = i;
+  return best;
+}
+
+struct Result {
+  double snrIn, snrOut;
+  double usPerBlock;
+};
+
+static Result runOne(NoiseSuppressor &ns, const std::vector<float> &clean,
+                     const std::vector<float> &noise, double snrDb,
+                     double learnGainDb, int delay) {
+  size_t lead = (size_t)NS_RATE * NS_LEAD_MS / 1000;
+  size_t total = lead + clean.size() + delay;
+
+  // Gürültüyü konuşma bölümünde istenen SNR'ye ölçekle
+  std::vector<float> n(total);
+  for (size_t i = 0; i < total; i++)
+    n[i] = noise[i % noise.size()];
+  double ec = energy(clean, 0, clean.size());
+  double en = energy(n, lead, clean.size());
+  float scale = en > 0 ? (float)sqrt(ec / (en * pow(10.0, snrDb / 10))) : 0;
+
+  float learnGain = (float)pow(10.0, learnGainDb / 20);
+  std::vector<int16_t> in(total), out(total);
+  std::vector<float> noisy(total);
+  for (size_t i = 0; i < total; i++) {
+    float s = (i >= lead && i - lead < clean.size()) ? clean[i - lead] : 0;
+    noisy[i] = s + scale * n[i];
+    in[i] = clip16(noisy[i] * (i < lead ? learnGain : 1.0f));
+  }
+
+  nsInit(ns);
+  double seconds = 0;
+  size_t blocks = 0;
+  for (size_t pos = 0; pos < total; pos += NS_BLOCK) {
+    int len = (int)std::min((size_t)NS_BLOCK, total - pos);
+    bool learn = pos + len <= lead;
+    auto t0 = std::chrono::steady_clock::now();
+    nsProcess(ns, &in[pos], &out[pos], len, learn, learn ? learnGain : 1.0f);
+    seconds += std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - t0)
+                   .count();
+    blocks++;
+  }
+
+  double errIn = 0, errOut = 0;
+  for (size_t i = 0; i < clean.size(); i++) {
+    double dIn = noisy[lead + i] - clean[i];
+    double dOut = out[lead + i + delay] - clean[i];
+    errIn += dIn * dIn;
+    errOut += dOut * dOut;
+  }
+  Result r;
+  r.snrIn = 10 * log10(ec / std::max(errIn, 1e-9));
+  r.snrOut = 10 * log10(ec / std::max(errOut, 1e-9));
+  r.usPerBlock = seconds * 1e6 / blocks;
+  return r;
+}
+
+int main(int argc, char **argv) {
+  std::vector<double> snrs = {0, 5, 10};
+  double learnGainDb = 0;
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-'; arg++) {
+    if (!strcmp(argv[arg], "-s") && arg + 1 < argc) {
+      snrs.clear();
+      for (char *p = strtok(argv[++arg], ","); p; p = strtok(NULL, ","))
+        snrs.push_back(atof(p));
+    } else if (!strcmp(argv[arg], "-g") && arg + 1 < argc) {
+      learnGainDb = atof(argv[++arg]);
+    } else {
+      break;
+    }
+  }
+  if (argc - arg < 2) {
+    fprintf(stderr, "Kullanım: %s [-s 0,5,10] [-g dB] gurultu.wav "
+                    "konusma.wav ...\n",
+            argv[0]);
+    return 2;
+  }
+
+  std::vector<float> noise;
+  if (!readWav(argv[arg++], noise))
+    return 1;
+
+  static NoiseSuppressor ns; // ~6 KB, yığında tutma
+  int delay = measureDelay(ns);
+  printf("Gecikme: %d örnek (%.1f ms), blok: %d örnek\n", delay,
+         delay * 1000.0 / NS_RATE, NS_BLOCK);
+  printf("%-28s %7s %8s %8s %8s %9s\n", "dosya", "hedef", "SNR gir",
+         "SNR çık", "kazanç", "us/blok");
+
+  double sumGain = 0, sumUs = 0;
+  int runs = 0;
+  for (; arg < argc; arg++) {
+    std::vector<float> clean;
+    if (!readWav(argv[arg], clean))
+      continue;
+    for (double snr : snrs) {
+      Result r = runOne(ns, clean, noise, snr, learnGainDb, delay);
+      printf("%-28s %5.0fdB %7.1fdB %7.1fdB %+7.1fdB %9.1f\n", argv[arg], snr,
+             r.snrIn, r.snrOut, r.snrOut - r.snrIn, r.usPerBlock);
+      sumGain += r.snrOut - r.snrIn;
+      sumUs += r.usPerBlock;
+      runs++;
+    }
+  }
+  if (runs == 0)
+    return 1;
+  double blockUs = NS_BLOCK * 1e6 / NS_RATE;
+  printf("Ortalama SNR kazancı: %+.1f dB | maliyet: %.1f us/blok "
+         "(%.2f%% gerçek zaman, bu makinede)\n",
+         sumGain / runs, sumUs / runs, 100.0 * (sumUs / runs) / blockUs);
+  return 0;
+}
@@ -0,0 +1,256 @@
+// ============================================
+//  AKIŞLI STT KÖPRÜSÜ — HOST YERİNE GEÇEN SUNUCU
+// ============================================
+//  delican.cpp'deki akışlı tanıma protokolünü (USE_STREAMING_STT) konuşan
+//  küçük bir TCP sunucusu. Google'a gitmez: gelen sesin enerjisine bakarak
+//  konuşma sonunu bildirir ve sabit bir metni son sonuç olarak döner.
+//  Cihazı buna yönlendirmek için config.h: STREAM_STT_HOST = bu makinenin
+//  IP'si, STREAM_STT_PORT = -p.
+//
+//  Protokol (cihaz -> köprü):
+//    {"encoding":"MULAW","sampleRateHertz":16000,...}\n
+//    [uint16 LE uzunluk][ses baytları] ..., uzunluk 0 = son
+//  Köprü -> cihaz, satır başına bir JSON:
+//    {"results":[{"alternatives":[{"transcript":"..."}],"isFinal":false}]}
+//    {"speechEventType":"END_OF_SINGLE_UTTERANCE"}
+//    {"results":[{"alternatives":[{"transcript":"..."}],"isFinal":true}]}
+//
+//  Derleme (depo kökünden):
+//    g++ -O2 -std=gnu++11 tools/stt_bridge_stub.cpp -o stt_bridge_stub
+//  Kullanım:
+//    ./stt_bridge_stub [-p 8765] [-t "salon ışığını aç"] [-s 700]
+//                      [-d 0] [-e] [-w kayit.wav]
+//  -s: konuşmadan sonra bu kadar ms sessizlikte konuşma sonu (0: hiç),
+//  -d: son sonucu bu kadar ms geciktir (cihazın zaman aşımı testi),
+//  -e: son sonuç yerine {"error":...} gönder, -w: alınan sesi WAV'a yaz.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BRIDGE_RATE 16000
+#define BRIDGE_SPEECH_RMS 800 // Bu seviyenin üstü konuşma sayılır
+#define BRIDGE_MAX_FRAME 4096
+
+// delican.cpp'deki mulawDecode ile aynı
+static int16_t mulawDecode(uint8_t u) {
+  u = ~u;
+  int exponent = (u >> 4) & 0x07;
+  int v = ((((u & 0x0F) << 3) + 0x84) << exponent) - 0x84;
+  return (int16_t)((u & 0x80) ? -v : v);
+}
+
+static bool readFull(int fd, void *buf, size_t n) {
+  uint8_t *p = (uint8_t *)buf;
+  while (n > 0) {
+    ssize_t k = recv(fd, p, n, 0);
+    if (k <= 0)
+      return false;
+    p += k;
+    n -= k;
+  }
+  return true;
+}
+
+static bool sendLine(int fd, const std::string &json) {
+  std::string line = json + "\n";
+  printf("  -> %s", line.c_str());
+  return send(fd, line.data(), line.size(), MSG_NOSIGNAL) ==
+         (ssize_t)line.size();
+}
+
+static std::string jsonEscape(const std::string &s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  return out;
+}
+
+static std::string result(const std::string &text, bool final) {
+  return "{\"results\":[{\"alternatives\":[{\"transcript\":\"" +
+         jsonEscape(text) + "\"}],\"isFinal\":" + (final ? "true" : "false") +
+         "}]}";
+}
+
+static void writeWav(const char *path, const std::vector<int16_t> &pcm) {
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return;
+  uint32_t data = (uint32_t)pcm.size() * 2, riff = 36 + data;
+  uint32_t rate = BRIDGE_RATE, byteRate = BRIDGE_RATE * 2, fmtSize = 16;
+  uint16_t format = 1, channels = 1, align = 2, bits = 16;
+  fwrite("RIFF", 1, 4, f);
+  fwrite(&riff, 4, 1, f);
+  fwrite("WAVEfmt ", 1, 8, f);
+  fwrite(&fmtSize, 4, 1, f);
+  fwrite(&format, 2, 1, f);
+  fwrite(&channels, 2, 1, f);
+  fwrite(&rate, 4, 1, f);
+  fwrite(&byteRate, 4, 1, f);
+  fwrite(&align, 2, 1, f);
+  fwrite(&bits, 2, 1, f);
+  fwrite("data", 1, 4, f);
+  fwrite(&data, 4, 1, f);
+  fwrite(pcm.data(), 2, pcm.size(), f);
+  fclose(f);
+}
+
+struct Options {
+  int port;
+  std::string text;
+  int silenceMs;
+  int finalDelayMs;
+  bool error;
+  const char *wavPath;
+};
+
+// Tek oturum: yapılandırma satırı, çerçeveler, son sonuç
+static void serve(int fd, const Options &o) {
+  auto t0 = std::chrono::steady_clock::now();
+  auto ms = [&] {
+    return (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - t0)
+        .count();
+  };
+
+  std::string config;
+  char c;
+  while (readFull(fd, &c, 1) && c != '\n')
+    config += c;
+  printf("  yapılandırma: %s\n", config.c_str());
+  bool mulaw = config.find("\"MULAW\"") != std::string::npos;
+
+  std::vector<int16_t> audio;
+  uint8_t frame[BRIDGE_MAX_FRAME];
+  bool speech = false, ended = false, interim = false;
+  size_t silentSamples = 0;
+  int frames = 0;
+  for (;;) {
+    uint8_t hdr[2];
+    if (!readFull(fd, hdr, 2)) {
+      printf("  bağlantı koptu (%d çerçeve, %ld ms)\n", frames, ms());
+      return;
+    }
+    size_t n = hdr[0] | hdr[1] << 8;
+    if (n == 0)
+      break;
+    if (n > sizeof(frame) || !readFull(fd, frame, n)) {
+      printf("  geçersiz çerçeve (%zu bayt)\n", n);
+      return;
+    }
+    frames++;
+
+    size_t first = audio.size();
+    if (mulaw) {
+      for (size_t i = 0; i < n; i++)
+        audio.push_back(mulawDecode(frame[i]));
+    } else {
+      for (size_t i = 0; i + 1 < n; i += 2)
+        audio.push_back((int16_t)(frame[i] | frame[i + 1] << 8));
+    }
+    double e = 0;
+    for (size_t i = first; i < audio.size(); i++)
+      e += (double)audio[i] * audio[i];
+    size_t got = audio.size() - first;
+    double rms = got ? sqrt(e / got) : 0;
+
+    if (rms > BRIDGE_SPEECH_RMS) {
+      if (!speech)
+        printf("  konuşma başladı (%ld ms)\n", ms());
+      speech = true;
+      silentSamples = 0;
+      if (!interim) // İlk kelime; cihaz ara sonuçları sadece loglar
+        interim = sendLine(fd, result(o.text.substr(0, o.text.find(' ')),
+                                      false));
+    } else if (speech) {
+      silentSamples += got;
+    }
+    if (speech && !ended && o.silenceMs > 0 &&
+        silentSamples * 1000 / BRIDGE_RATE >= (size_t)o.silenceMs) {
+      ended = true;
+      sendLine(fd, "{\"speechEventType\":\"END_OF_SINGLE_UTTERANCE\"}");
+    }
+  }
+  printf("  ses bitti: %d çerçeve, %.2f sn (%ld ms)\n", frames,
+         (double)audio.size() / BRIDGE_RATE, ms());
+  if (o.wavPath)
+    writeWav(o.wavPath, audio);
+
+  if (o.finalDelayMs > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(o.finalDelayMs));
+  if (o.error)
+    sendLine(fd, "{\"error\":{\"code\":13,\"message\":\"test hatası\"}}");
+  else
+    sendLine(fd, result(o.text, true));
+}
+
+int main(int argc, char **argv) {
+  Options o = {8765, "salon ışığını aç", 700, 0, false, NULL};
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-p") && i + 1 < argc)
+      o.port = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+      o.text = argv[++i];
+    else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+      o.silenceMs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+      o.finalDelayMs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-e"))
+      o.error = true;
+    else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+      o.wavPath = argv[++i];
+    else {
+      fprintf(stderr, "Kullanım: %s [-p 8765] [-t metin] [-s 700] [-d 0] "
+                      "[-e] [-w kayit.wav]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  int srv = socket(AF_INET, SOCK_STREAM, 0);
+  int yes = 1;
+  setsockopt(srv, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(o.port);
+  if (srv < 0 || bind(srv, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(srv, 1) < 0) {
+    perror("dinlenemedi");
+    return 1;
+  }
+  printf("Köprü :%d dinliyor (metin: \"%s\", sessizlik %d ms)\n", o.port,
+         o.text.c_str(), o.silenceMs);
+  fflush(stdout);
+
+  // Cihaz aynı anda tek oturum açar: sırayla hizmet et
+  for (;;) {
+    sockaddr_in peer;
+    socklen_t len = sizeof(peer);
+    int fd = accept(srv, (sockaddr *)&peer, &len);
+    if (fd < 0)
+      continue;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    printf("Oturum: %s\n", inet_ntoa(peer.sin_addr));
+    serve(fd, o);
+    close(fd);
+    fflush(stdout);
+  }
+}
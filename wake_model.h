@@ -0,0 +1,170 @@
+#ifndef WAKE_MODEL_H
+#define WAKE_MODEL_H
+
+// ============================================
+//  UYANMA MODELİ BÖLÜMÜ (flash, esp_partition_mmap)
+// ============================================
+//  Model uygulamaya gömülmez; "wakemodel" veri bölümünde (partitions.csv)
+//  iki yuvada durur. Her yuva: 64 baytlık sürümlü başlık + model baytları.
+//  Açılışta geçerli (sihirli sayı, biçim, boyut, CRC) ve model sürümü en
+//  yüksek yuva belleğe eşlenir: RAM'e kopya yok, model flash'tan okunur.
+//
+//  Güncelleme her zaman eşli OLMAYAN yuvaya yazılır; başlık en son yazılır,
+//  yani yarıda kesilen güncelleme eski modeli bozmaz (A/B).
+//
+//  Ağdan yükleme (delican.cpp, WAKE_MODEL_PORT):
+//    curl -T hey_alex.ppn "http://<ip>:9101/wake-model?version=2&name=hey_alex"
+
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <stdint.h>
+#include <string.h>
+
+#define WAKE_MODEL_MAGIC 0x4D4B4157 // "WAKM"
+#define WAKE_MODEL_FORMAT 1
+#define WAKE_MODEL_HEADER_BYTES 64
+#define WAKE_MODEL_PARTITION_LABEL "wakemodel"
+#define WAKE_MODEL_PARTITION_SUBTYPE 0x40
+#define WAKE_MODEL_SECTOR 4096
+
+struct WakeModelHeader {
+  uint32_t magic;
+  uint16_t format;     // Başlık biçimi (WAKE_MODEL_FORMAT)
+  uint16_t headerSize; // Model baytlarının yuva içindeki başlangıcı
+  uint32_t version;    // Model sürümü; büyük olan kazanır
+  uint32_t size;       // Model bayt sayısı
+  uint32_t crc32;      // Model baytlarının CRC32'si (esp_rom_crc32_le)
+  char name[24];
+  uint8_t reserved[WAKE_MODEL_HEADER_BYTES - 44];
+};
+
+struct WakeModel {
+  const esp_partition_t *part;
+  size_t slotSize;
+  int slot; // Eşli yuva, -1: geçerli model yok
+  WakeModelHeader header;
+  const uint8_t *data; // Flash'a eşli, sadece okunur
+  size_t size;
+  spi_flash_mmap_handle_t mmap;
+};
+
+struct WakeModelWriter {
+  int slot;
+  size_t written;
+  uint32_t crc;
+  WakeModelHeader header;
+};
+
+inline bool wakeModelHeaderOk(const WakeModel &m, const WakeModelHeader &h) {
+  return h.magic == WAKE_MODEL_MAGIC && h.format == WAKE_MODEL_FORMAT &&
+         h.headerSize >= sizeof(WakeModelHeader) && h.size > 0 &&
+         h.headerSize + (size_t)h.size <= m.slotSize;
+}
+
+inline void wakeModelClose(WakeModel &m) {
+  if (m.data)
+    spi_flash_munmap(m.mmap);
+  m.data = NULL;
+  m.size = 0;
+  m.slot = -1;
+}
+
+// Yuvayı eşler ve CRC'yi eşli bellekten doğrular (kopya yok)
+inline bool wakeModelMapSlot(WakeModel &m, int slot,
+                             const WakeModelHeader &h) {
+  const void *ptr = NULL;
+  spi_flash_mmap_handle_t handle;
+  if (esp_partition_mmap(m.part, slot * m.slotSize + h.headerSize, h.size,
+                         ESP_PARTITION_MMAP_DATA, &ptr,
+                         &handle) != ESP_OK)
+    return false;
+  if (esp_rom_crc32_le(0, (const uint8_t *)ptr, h.size) != h.crc32) {
+    spi_flash_munmap(handle);
+    return false;
+  }
+  m.data = (const uint8_t *)ptr;
+  m.size = h.size;
+  m.mmap = handle;
+  m.slot = slot;
+  m.header = h;
+  return true;
+}
+
+// Bölümü bulur, en yeni geçerli modeli eşler. false: bölüm ya da model yok.
+inline bool wakeModelOpen(WakeModel &m) {
+  m.data = NULL;
+  m.size = 0;
+  m.slot = -1;
+  m.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                    (esp_partition_subtype_t)
+                                        WAKE_MODEL_PARTITION_SUBTYPE,
+                                    WAKE_MODEL_PARTITION_LABEL);
+  if (!m.part)
+    return false;
+  m.slotSize = (m.part->size / 2) & ~(size_t)(WAKE_MODEL_SECTOR - 1);
+
+  WakeModelHeader h[2];
+  bool ok[2];
+  for (int s = 0; s < 2; s++)
+    ok[s] = esp_partition_read(m.part, s * m.slotSize, &h[s], sizeof(h[s])) ==
+                ESP_OK &&
+            wakeModelHeaderOk(m, h[s]);
+  // Önce yeni sürüm; CRC tutmazsa diğer yuvaya düş
+  int first = (ok[1] && (!ok[0] || h[1].version > h[0].version)) ? 1 : 0;
+  for (int i = 0; i < 2; i++) {
+    int s = i == 0 ? first : 1 - first;
+    if (ok[s] && wakeModelMapSlot(m, s, h[s]))
+      return true;
+  }
+  return false;
+}
+
+// Eşli olmayan yuvayı siler ve yazmaya hazırlar
+inline esp_err_t wakeModelWriteBegin(const WakeModel &m, WakeModelWriter &w,
+                                     size_t size, uint32_t version,
+                                     const char *name) {
+  if (!m.part)
+    return ESP_ERR_NOT_FOUND;
+  if (size == 0 || WAKE_MODEL_HEADER_BYTES + size > m.slotSize)
+    return ESP_ERR_INVALID_SIZE;
+  if (m.slot >= 0 && version <= m.header.version)
+    return ESP_ERR_INVALID_VERSION;
+  w.slot = (m.slot == 0) ? 1 : 0;
+  w.written = 0;
+  w.crc = 0;
+  memset(&w.header, 0, sizeof(w.header));
+  w.header.magic = WAKE_MODEL_MAGIC;
+  w.header.format = WAKE_MODEL_FORMAT;
+  w.header.headerSize = WAKE_MODEL_HEADER_BYTES;
+  w.header.version = version;
+  w.header.size = size;
+  strncpy(w.header.name, name, sizeof(w.header.name) - 1);
+  size_t erase = (WAKE_MODEL_HEADER_BYTES + size + WAKE_MODEL_SECTOR - 1) &
+                 ~(size_t)(WAKE_MODEL_SECTOR - 1);
+  return esp_partition_erase_range(m.part, w.slot * m.slotSize, erase);
+}
+
+inline esp_err_t wakeModelWrite(const WakeModel &m, WakeModelWriter &w,
+                                const uint8_t *data, size_t n) {
+  if (w.written + n > w.header.size)
+    return ESP_ERR_INVALID_SIZE;
+  esp_err_t err = esp_partition_write(
+      m.part, w.slot * m.slotSize + WAKE_MODEL_HEADER_BYTES + w.written, data,
+      n);
+  if (err != ESP_OK)
+    return err;
+  w.crc = esp_rom_crc32_le(w.crc, data, n);
+  w.written += n;
+  return ESP_OK;
+}
+
+// Başlık en son yazılır: bundan önce kesilen yükleme geçersiz yuva bırakır
+inline esp_err_t wakeModelWriteEnd(const WakeModel &m, WakeModelWriter &w) {
+  if (w.written != w.header.size)
+    return ESP_ERR_INVALID_SIZE;
+  w.header.crc32 = w.crc;
+  return esp_partition_write(m.part, w.slot * m.slotSize, &w.header,
+                             sizeof(w.header));
+}
+
+#endif // WAKE_MODEL_H
@@ -13,13 +13,7 @@
 
 #include <driver/i2s.h>
 
-// === PIN TANIMLAMALARI ===
-#define I2S_WS_PIN     5
-#define I2S_SCK_PIN    6
-#define I2S_SD_PIN     4
-#define I2S_PORT       I2S_NUM_0
-#define SAMPLE_RATE    16000
-#define BUFFER_LENGTH  512
+#include "audio_pipeline.h" // Pinler, SAMPLE_RATE, I2S kurulumu
 
 // === DURUM MAKİNESİ ===
 typedef enum {
@@ -70,7 +64,7 @@ void setup() {
 void loop() {
   size_t bytesRead = 0;
   esp_err_t result = i2s_read(
-    I2S_PORT,
+    MIC_PORT,
     &rawBuffer,
     sizeof(rawBuffer),
     &bytesRead,
@@ -80,7 +74,7 @@ void loop() {
   if (result != ESP_OK || bytesRead == 0) return;
 
   int samplesRead = bytesRead / sizeof(int32_t);
-  float rms = calculateRMS(samplesRead);
+  float rms = MicAudio::rms(rawBuffer, samplesRead);
 
   switch (currentState) {
 
@@ -109,8 +103,10 @@ void loop() {
       }
 
       // Kayıt tamponuna ekle
-      for (int i = 0; i < samplesRead && recordIndex < MAX_RECORD_SAMPLES; i++) {
-        recordBuffer[recordIndex++] = (int16_t)(rawBuffer[i] >> 16);
+      {
+        int n = min(samplesRead, MAX_RECORD_SAMPLES - recordIndex);
+        MicAudio::toPcm16(rawBuffer, recordBuffer + recordIndex, n);
+        recordIndex += n;
       }
 
       // Sessizlik zaman aşımı → konuşma bitti
@@ -158,41 +154,8 @@ void setState(SystemState newState) {
   }
 }
 
-// === RMS HESAPLA ===
-float calculateRMS(int samplesRead) {
-  long long sumSquares = 0;
-  for (int i = 0; i < samplesRead; i++) {
-    int32_t sample = rawBuffer[i] >> 14;
-    sumSquares += (long long)sample * sample;
-  }
-  return sqrt((float)sumSquares / samplesRead);
-}
-
 // === I2S BAŞLATMA ===
 void i2s_init() {
-  i2s_config_t i2s_config = {
-    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-    .sample_rate = SAMPLE_RATE,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
-    .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-    .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-    .dma_buf_count = 8,
-    .dma_buf_len = BUFFER_LENGTH,
-    .use_apll = false,
-    .tx_desc_auto_clear = false,
-    .fixed_mclk = 0
-  };
-
-  i2s_pin_config_t pin_config = {
-    .bck_io_num   = I2S_SCK_PIN,
-    .ws_io_num    = I2S_WS_PIN,
-    .data_out_num = I2S_PIN_NO_CHANGE,
-    .data_in_num  = I2S_SD_PIN
-  };
-
-  i2s_driver_install(I2S_PORT, &i2s_config, 0, NULL);
-  i2s_set_pin(I2S_PORT, &pin_config);
-  i2s_zero_dma_buffer(I2S_PORT);
+  MicAudio::install(MIC_PORT);
   Serial.println("I2S Mikrofon hazır!");
 }
@@ -12,6 +12,8 @@
 #include <driver/i2s.h>
 #include <base64.h>
 
+#include "audio_pipeline.h" // Pinler, SAMPLE_RATE, I2S kurulumu
+
 // === Wi-Fi BİLGİLERİ ===
 #define WIFI_SSID     "Ağ_Adın"
 #define WIFI_PASSWORD "Şifren"
@@ -24,21 +26,6 @@
 #define TTS_URL  "https://texttospeech.googleapis.com/v1/text:synthesize?key=" GOOGLE_API_KEY
 #define LLM_URL  "https://generativelanguage.googleapis.com/v1beta/models/gemini-pro:generateContent?key=" GOOGLE_API_KEY
 
-// === MİKROFON PİNLERİ ===
-#define I2S_WS_PIN     5
-#define I2S_SCK_PIN    6
-#define I2S_SD_PIN     4
-#define MIC_PORT       I2S_NUM_0
-
-// === HOPARLÖR PİNLERİ ===
-#define I2S_BCLK_PIN   9
-#define I2S_LRC_PIN    10
-#define I2S_DIN_PIN    8
-#define SPK_PORT       I2S_NUM_1
-
-#define SAMPLE_RATE    16000
-#define BUFFER_LENGTH  512
-
 // PSRAM kayıt tamponu
 #define MAX_RECORD_SAMPLES (SAMPLE_RATE * 5)
 int16_t* recordBuffer = nullptr;
@@ -93,7 +80,7 @@ void loop() {
   if (bytesRead == 0) return;
 
   int samplesRead = bytesRead / sizeof(int32_t);
-  float rms = calculateRMS(samplesRead);
+  float rms = MicAudio::rms(rawBuffer, samplesRead);
 
   switch (currentState) {
 
@@ -115,8 +102,10 @@ void loop() {
     case STATE_LISTENING:
       if (rms > WAKE_THRESHOLD / 2) lastSoundTime = millis();
 
-      for (int i = 0; i < samplesRead && recordIndex < MAX_RECORD_SAMPLES; i++) {
-        recordBuffer[recordIndex++] = (int16_t)(rawBuffer[i] >> 16);
+      {
+        int n = min(samplesRead, MAX_RECORD_SAMPLES - recordIndex);
+        MicAudio::toPcm16(rawBuffer, recordBuffer + recordIndex, n);
+        recordIndex += n;
       }
 
       if (millis() - lastSoundTime > SILENCE_TIMEOUT_MS || recordIndex >= MAX_RECORD_SAMPLES) {
@@ -347,15 +336,6 @@ void wifi_connect() {
 // ============================================
 //  YARDIMCI FONKSİYONLAR
 // ============================================
-float calculateRMS(int samplesRead) {
-  long long sumSquares = 0;
-  for (int i = 0; i < samplesRead; i++) {
-    int32_t sample = rawBuffer[i] >> 14;
-    sumSquares += (long long)sample * sample;
-  }
-  return sqrt((float)sumSquares / samplesRead);
-}
-
 void setState(SystemState newState) {
   currentState = newState;
   const char* states[] = {"IDLE", "LISTENING", "THINKING", "SPEAKING"};
@@ -365,41 +345,9 @@ void setState(SystemState newState) {
 }
 
 void i2s_mic_init() {
-  i2s_config_t cfg = {
-    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-    .sample_rate = SAMPLE_RATE,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
-    .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-    .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-    .dma_buf_count = 8, .dma_buf_len = BUFFER_LENGTH,
-    .use_apll = false, .tx_desc_auto_clear = false, .fixed_mclk = 0
-  };
-  i2s_pin_config_t pins = {
-    .bck_io_num = I2S_SCK_PIN, .ws_io_num = I2S_WS_PIN,
-    .data_out_num = I2S_PIN_NO_CHANGE, .data_in_num = I2S_SD_PIN
-  };
-  i2s_driver_install(MIC_PORT, &cfg, 0, NULL);
-  i2s_set_pin(MIC_PORT, &pins);
-  i2s_zero_dma_buffer(MIC_PORT);
+  MicAudio::install(MIC_PORT);
 }
 
 void i2s_speaker_init() {
-  i2s_config_t cfg = {
-    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
-    .sample_rate = SAMPLE_RATE,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-    .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-    .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-    .dma_buf_count = 8, .dma_buf_len = BUFFER_LENGTH,
-    .use_apll = false, .tx_desc_auto_clear = true, .fixed_mclk = 0
-  };
-  i2s_pin_config_t pins = {
-    .bck_io_num = I2S_BCLK_PIN, .ws_io_num = I2S_LRC_PIN,
-    .data_out_num = I2S_DIN_PIN, .data_in_num = I2S_PIN_NO_CHANGE
-  };
-  i2s_driver_install(SPK_PORT, &cfg, 0, NULL);
-  i2s_set_pin(SPK_PORT, &pins);
-  i2s_zero_dma_buffer(SPK_PORT);
+  SpeakerAudio::install(SPK_PORT);
 }
\ No newline at end of file